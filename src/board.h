@@ -50,6 +50,15 @@ static inline void readInitialBoardState(Board *board) {
     }
 }
 
+static inline void copyBoard(Board *dst, Board *src) {
+    initBoard(dst);
+    for (int i = 0; i < src->size; i++) {
+        Row *row = getNewRow();
+        loadSquaresToRow(row, src->rows[i]->squares, src->rows[i]->size);
+        addToBoard(dst, row);
+    }
+}
+
 static inline bool isPositionInRange(Board *board, Position *pos) {
     return (0 <= pos->row && pos->row < board->size)
            && (0 <= pos->col && pos->col < board->rows[pos->row]->size);
@@ -0,0 +1,93 @@
+#ifndef BOARD_DIFF_H
+#define BOARD_DIFF_H
+
+#include "game.h"
+
+/* Single command, macro push included, changes at most squares of player
+ * and chest before and after the command. */
+#define MAX_BOARD_DIFF_SIZE 4
+
+struct SquareChange {
+    Position pos;
+    char square;
+};
+
+typedef struct SquareChange SquareChange;
+
+/* Squares which may be changed by a command. Squares are watched before
+ * the command is executed and collected after it, so that only squares
+ * which really changed are left together with their new content. */
+struct BoardDiff {
+    SquareChange changes[MAX_BOARD_DIFF_SIZE];
+    int size;
+};
+
+typedef struct BoardDiff BoardDiff;
+
+static inline void initBoardDiff(BoardDiff *diff) {
+    diff->size = 0;
+}
+
+static inline void watchSquare(BoardDiff *diff, Game *game, Position *pos) {
+    for (int i = 0; i < diff->size; i++) {
+        if (arePositionsEqual(&diff->changes[i].pos, pos)) {
+            return;
+        }
+    }
+    assert(diff->size < MAX_BOARD_DIFF_SIZE);
+    diff->changes[diff->size].pos = *pos;
+    diff->changes[diff->size].square = getSquare(game, pos);
+    diff->size++;
+}
+
+static inline void watchPushCommandSquares(BoardDiff *diff, Game *game,
+                                           PushCommand *pushComm, int numOfPushes) {
+    Position chestPos = *getChestPosition(game, pushComm->chestNum);
+
+    watchSquare(diff, game, game->playerPos);
+    watchSquare(diff, game, &chestPos);
+    for (int i = 0; i < numOfPushes; i++) {
+        chestPos.row = getPushedChestRowNumber(chestPos.row, pushComm->direction);
+        chestPos.col = getPushedChestColNumber(chestPos.col, pushComm->direction);
+    }
+    Position playerPos;
+    playerPos.row = getPushedChestRowNumber(chestPos.row,
+                                            getOppositeDirection(pushComm->direction));
+    playerPos.col = getPushedChestColNumber(chestPos.col,
+                                            getOppositeDirection(pushComm->direction));
+    watchSquare(diff, game, &playerPos);
+    watchSquare(diff, game, &chestPos);
+}
+
+static inline void watchUndoCommandSquares(BoardDiff *diff, Game *game,
+                                           MoveStack *stack) {
+    Move *pastMove = top(stack);
+    Position chestPos = *getChestPosition(game, pastMove->chestNum);
+
+    watchSquare(diff, game, game->playerPos);
+    watchSquare(diff, game, &chestPos);
+    char backward = getOppositeDirection(pastMove->direction);
+    for (int i = 0; i < pastMove->numOfPushes; i++) {
+        chestPos.row = getPushedChestRowNumber(chestPos.row, backward);
+        chestPos.col = getPushedChestColNumber(chestPos.col, backward);
+    }
+    watchSquare(diff, game, &chestPos);
+    watchSquare(diff, game, pastMove->prevPlayerPos);
+}
+
+/* Leaves only squares which changed since they were watched
+ * and stores their current content. */
+static inline void collectBoardDiff(BoardDiff *diff, Game *game) {
+    int size = 0;
+    for (int i = 0; i < diff->size; i++) {
+        char square = getSquare(game, &diff->changes[i].pos);
+        if (square != diff->changes[i].square) {
+            diff->changes[size].pos = diff->changes[i].pos;
+            diff->changes[size].square = square;
+            size++;
+        }
+    }
+    diff->size = size;
+}
+
+#endif // BOARD_DIFF_H
@@ -1,9 +1,13 @@
 #ifndef COMMAND_H
 #define COMMAND_H
 
+#include <stdbool.h>
+
 #include "move.h"
 
 #define UNDO_COMMAND '0'
+#define END_OF_DATA '.'
+#define HINT_COMMAND '?'
 
 struct PushCommand {
     int chestNum;
@@ -12,6 +16,15 @@ struct PushCommand {
 
 typedef struct PushCommand PushCommand;
 
+static inline bool isDirectionCommand(int c) {
+    return c == DOWN || c == UP || c == LEFT || c == RIGHT;
+}
+
+/* Macro push names the chest with uppercase letter. */
+static inline bool isMacroPushCommand(int c) {
+    return 'A' <= c && c <= 'Z';
+}
+
 static inline int getPushedChestRowNumber(int row, char pushDirection) {
     if (pushDirection == DOWN) {
         return row + 1;
@@ -0,0 +1,47 @@
+#ifndef COMMAND_LIST_H
+#define COMMAND_LIST_H
+
+#include <stdio.h>
+
+#include "command.h"
+#include "row.h"
+#include "squares.h"
+
+struct CommandList {
+    PushCommand *commands;
+    int size;
+    int capacity;
+};
+
+typedef struct CommandList CommandList;
+
+static inline void initCommandList(CommandList *list) {
+    list->size = 0;
+    list->capacity = INITIAL_CAPACITY;
+    list->commands = malloc(list->capacity * sizeof(PushCommand));
+    assert(list->commands != NULL);
+}
+
+static inline void addToCommandList(CommandList *list, int chestNum, char direction) {
+    if (list->size == list->capacity) {
+        list->capacity *= GROWTH_FACTOR;
+        list->commands = realloc(list->commands, list->capacity * sizeof(PushCommand));
+        assert(list->commands != NULL);
+    }
+    list->commands[list->size].chestNum = chestNum;
+    list->commands[list->size].direction = direction;
+    list->size++;
+}
+
+static inline void printCommandList(CommandList *list) {
+    for (int i = 0; i < list->size; i++) {
+        printf("%c%c\n", getChestName(list->commands[i].chestNum, BLANK_SQUARE),
+               list->commands[i].direction);
+    }
+}
+
+static inline void disposeCommandList(CommandList *list) {
+    free(list->commands);
+}
+
+#endif // COMMAND_LIST_H
@@ -0,0 +1,98 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdint.h>
+
+#include "board.h"
+#include "squares.h"
+
+#if defined(__clang__)
+#define ENGINE_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define ENGINE_UNROLL _Pragma("GCC unroll 32")
+#else
+#define ENGINE_UNROLL
+#endif
+
+#define ENGINE_CONCAT(name, size) name##size
+#define ENGINE_EXPAND(name, size) ENGINE_CONCAT(name, size)
+
+#define ENGINE_SIZE 16
+#define ENGINE_ROW uint16_t
+#include "engine_template.h"
+#undef ENGINE_SIZE
+#undef ENGINE_ROW
+
+#define ENGINE_SIZE 32
+#define ENGINE_ROW uint32_t
+#include "engine_template.h"
+#undef ENGINE_SIZE
+#undef ENGINE_ROW
+
+enum EngineType {
+    DYNAMIC_ENGINE,
+    ENGINE_16,
+    ENGINE_32
+};
+
+typedef enum EngineType EngineType;
+
+/* Engine answering push and reachability queries of the game, chosen
+ * by size of the board. Boards larger than the largest size class are
+ * searched square by square on the board itself. */
+struct Engine {
+    EngineType type;
+    union {
+        Engine16 engine16;
+        Engine32 engine32;
+    };
+};
+
+typedef struct Engine Engine;
+
+static inline void selectEngine(Engine *engine, Board *board) {
+    if (doesBoardFitEngine16(board)) {
+        engine->type = ENGINE_16;
+        initEngine16(&engine->engine16, board);
+    }
+    else if (doesBoardFitEngine32(board)) {
+        engine->type = ENGINE_32;
+        initEngine32(&engine->engine32, board);
+    }
+    else {
+        engine->type = DYNAMIC_ENGINE;
+    }
+}
+
+static inline bool isDynamicEngine(Engine *engine) {
+    return engine->type == DYNAMIC_ENGINE;
+}
+
+/* Functions below are not called for dynamic engine. */
+
+static inline bool isFreeInEngine(Engine *engine, Position *pos) {
+    if (engine->type == ENGINE_16) {
+        return isFreeInEngine16(&engine->engine16, pos);
+    }
+    return isFreeInEngine32(&engine->engine32, pos);
+}
+
+static inline bool isReachableInEngine(Engine *engine, Position *from, Position *to) {
+    if (engine->type == ENGINE_16) {
+        return isReachableInEngine16(&engine->engine16, from, to);
+    }
+    return isReachableInEngine32(&engine->engine32, from, to);
+}
+
+/* Keeps engine in step with chest moved on the board, does nothing
+ * for dynamic engine. */
+static inline void moveChestInEngine(Engine *engine, Position *from, Position *to) {
+    if (engine->type == ENGINE_16) {
+        moveChestInEngine16(&engine->engine16, from, to);
+    }
+    else if (engine->type == ENGINE_32) {
+        moveChestInEngine32(&engine->engine32, from, to);
+    }
+}
+
+#endif // ENGINE_H
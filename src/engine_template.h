@@ -0,0 +1,108 @@
+/* Engine specialized for boards fitting into ENGINE_SIZE x ENGINE_SIZE
+ * squares, included once for every size class by engine.h, with ENGINE_SIZE
+ * and ENGINE_ROW, unsigned type of at least ENGINE_SIZE bits, defined.
+ * Every row of the board is a bit set of its squares, bit i standing for
+ * column i. Engine keeps walls and chests of the board in fixed arrays,
+ * pushes move chests in them, so that targets of pushes are checked
+ * and player's reachable area is flood filled a whole row at a time
+ * with fixed number of rows, without touching the board or allocating. */
+
+#define ENGINE_NAME(name) ENGINE_EXPAND(name, ENGINE_SIZE)
+
+struct ENGINE_NAME(Engine) {
+    /* Squares which are not walls. */
+    ENGINE_ROW floor[ENGINE_SIZE];
+    /* Squares taken by chests, a subset of floor. */
+    ENGINE_ROW chests[ENGINE_SIZE];
+};
+
+typedef struct ENGINE_NAME(Engine) ENGINE_NAME(Engine);
+
+static inline bool ENGINE_NAME(doesBoardFitEngine)(Board *board) {
+    if (board->size > ENGINE_SIZE) {
+        return false;
+    }
+    for (int i = 0; i < board->size; i++) {
+        if (board->rows[i]->size > ENGINE_SIZE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline void ENGINE_NAME(initEngine)(ENGINE_NAME(Engine) *engine, Board *board) {
+    for (int i = 0; i < ENGINE_SIZE; i++) {
+        engine->floor[i] = 0;
+        engine->chests[i] = 0;
+    }
+    for (int i = 0; i < board->size; i++) {
+        for (int j = 0; j < board->rows[i]->size; j++) {
+            char square = board->rows[i]->squares[j];
+            if (!isWallSquare(square)) {
+                engine->floor[i] |= (ENGINE_ROW) 1 << j;
+            }
+            if (isChestSquare(square)) {
+                engine->chests[i] |= (ENGINE_ROW) 1 << j;
+            }
+        }
+    }
+}
+
+/* Tells if a chest can be pushed onto given position, which may be
+ * out of range of the board. */
+static inline bool ENGINE_NAME(isFreeInEngine)(ENGINE_NAME(Engine) *engine, Position *pos) {
+    if (pos->row < 0 || pos->row >= ENGINE_SIZE || pos->col < 0 || pos->col >= ENGINE_SIZE) {
+        return false;
+    }
+    ENGINE_ROW freeSquares = engine->floor[pos->row] & ~engine->chests[pos->row];
+    return ((freeSquares >> pos->col) & 1) != 0;
+}
+
+static inline void ENGINE_NAME(moveChestInEngine)(ENGINE_NAME(Engine) *engine,
+                                                  Position *from, Position *to) {
+    engine->chests[from->row] &= ~((ENGINE_ROW) 1 << from->col);
+    engine->chests[to->row] |= (ENGINE_ROW) 1 << to->col;
+}
+
+/* Tells if player can walk from one position to the other, both of them
+ * being in range of the board, without passing through chests. */
+static inline bool ENGINE_NAME(isReachableInEngine)(ENGINE_NAME(Engine) *engine,
+                                                    Position *from, Position *to) {
+    ENGINE_ROW freeSquares[ENGINE_SIZE];
+    ENGINE_ROW reach[ENGINE_SIZE];
+    ENGINE_UNROLL
+    for (int i = 0; i < ENGINE_SIZE; i++) {
+        freeSquares[i] = engine->floor[i] & ~engine->chests[i];
+        reach[i] = 0;
+    }
+
+    ENGINE_ROW target = (ENGINE_ROW) 1 << to->col;
+    reach[from->row] = ((ENGINE_ROW) 1 << from->col) & freeSquares[from->row];
+    bool isChanged = reach[from->row] != 0;
+    while (isChanged && (reach[to->row] & target) == 0) {
+        /* Sweeps down and up, so that area grows along whole columns
+         * in a single pass. */
+        isChanged = false;
+        ENGINE_UNROLL
+        for (int i = 0; i < ENGINE_SIZE; i++) {
+            ENGINE_ROW grown = reach[i] | (ENGINE_ROW) (reach[i] << 1) | (reach[i] >> 1)
+                               | (i > 0 ? reach[i - 1] : 0)
+                               | (i < ENGINE_SIZE - 1 ? reach[i + 1] : 0);
+            grown &= freeSquares[i];
+            isChanged = isChanged || grown != reach[i];
+            reach[i] = grown;
+        }
+        ENGINE_UNROLL
+        for (int i = ENGINE_SIZE - 1; i >= 0; i--) {
+            ENGINE_ROW grown = reach[i] | (ENGINE_ROW) (reach[i] << 1) | (reach[i] >> 1)
+                               | (i > 0 ? reach[i - 1] : 0)
+                               | (i < ENGINE_SIZE - 1 ? reach[i + 1] : 0);
+            grown &= freeSquares[i];
+            isChanged = isChanged || grown != reach[i];
+            reach[i] = grown;
+        }
+    }
+    return (reach[to->row] & target) != 0;
+}
+
+#undef ENGINE_NAME
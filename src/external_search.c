@@ -0,0 +1,671 @@
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "external_search.h"
+
+#define KEY_FILE_BUFFER_SIZE (64 * 1024)
+#define MAX_MERGE_FAN_IN 32
+#define MAX_FILE_PATH_SIZE 4096
+/* Leaves room for names of files in the directory. */
+#define MAX_DIRECTORY_SIZE (MAX_FILE_PATH_SIZE - 32)
+#define MIN_RUN_CAPACITY 1024
+#define SHARED_PREFIX_SIZE 2
+
+/* Returns false if the file could not be created. */
+static bool openKeyWriter(KeyWriter *writer, const char *path, int keySize) {
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL) {
+        perror(path);
+        return false;
+    }
+    setvbuf(writer->file, NULL, _IOFBF, KEY_FILE_BUFFER_SIZE);
+    writer->previous = malloc(keySize);
+    assert(writer->previous != NULL);
+    writer->keySize = keySize;
+    writer->hasPrevious = false;
+    writer->numOfKeys = 0;
+    return true;
+}
+
+static void writeKey(KeyWriter *writer, const unsigned char *key) {
+    int shared = 0;
+    if (writer->hasPrevious) {
+        while (shared < writer->keySize && key[shared] == writer->previous[shared]) {
+            shared++;
+        }
+    }
+    fputc(shared >> BITS_IN_BYTE, writer->file);
+    fputc(shared & 0xFF, writer->file);
+    fwrite(key + shared, 1, writer->keySize - shared, writer->file);
+
+    memcpy(writer->previous, key, writer->keySize);
+    writer->hasPrevious = true;
+    writer->numOfKeys++;
+}
+
+/* Returns false if some of the keys could not be written, for example
+ * because the disk is full. Errors of writes are sticky, so they are
+ * checked once, when all buffered data is flushed. */
+static bool closeKeyWriter(KeyWriter *writer) {
+    bool isWritten = ferror(writer->file) == 0;
+    if (fclose(writer->file) != 0) {
+        isWritten = false;
+    }
+    free(writer->previous);
+    return isWritten;
+}
+
+/* Reads the next key. File ending in the middle of a key or with shared
+ * prefix longer than a key is marked as corrupted. */
+static void readNextKey(KeyReader *reader) {
+    reader->hasKey = false;
+    int high = fgetc(reader->file);
+    if (high == EOF) {
+        return;
+    }
+    int low = fgetc(reader->file);
+    int shared = (high << BITS_IN_BYTE) | low;
+    if (low == EOF || shared > reader->keySize) {
+        reader->isCorrupted = true;
+        return;
+    }
+    size_t size = (size_t) (reader->keySize - shared);
+    if (fread(reader->key + shared, 1, size, reader->file) != size) {
+        reader->isCorrupted = true;
+        return;
+    }
+    reader->hasKey = true;
+}
+
+/* Returns false if the file could not be opened. */
+static bool openKeyReader(KeyReader *reader, const char *path, int keySize) {
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL) {
+        perror(path);
+        return false;
+    }
+    setvbuf(reader->file, NULL, _IOFBF, KEY_FILE_BUFFER_SIZE);
+    reader->key = malloc(keySize);
+    assert(reader->key != NULL);
+    reader->keySize = keySize;
+    reader->isCorrupted = false;
+    readNextKey(reader);
+    return true;
+}
+
+/* Returns false if reading failed, in which case keys read were incomplete. */
+static bool closeKeyReader(KeyReader *reader) {
+    bool isRead = !reader->isCorrupted && ferror(reader->file) == 0;
+    fclose(reader->file);
+    free(reader->key);
+    return isRead;
+}
+
+/* Merges sorted files, giving their keys in order together with number
+ * of file each of them comes from. */
+struct KeyMerger {
+    KeyReader readers[MAX_MERGE_FAN_IN + 1];
+    int numOfReaders;
+    int heap[MAX_MERGE_FAN_IN + 1];
+    int heapSize;
+};
+
+typedef struct KeyMerger KeyMerger;
+
+static bool isReaderBefore(KeyMerger *merger, int reader1, int reader2) {
+    int result = memcmp(merger->readers[reader1].key, merger->readers[reader2].key,
+                        merger->readers[reader1].keySize);
+    return result < 0 || (result == 0 && reader1 < reader2);
+}
+
+static void siftDownReader(KeyMerger *merger, int i) {
+    int reader = merger->heap[i];
+    while (2 * i + 1 < merger->heapSize) {
+        int child = 2 * i + 1;
+        if (child + 1 < merger->heapSize
+            && isReaderBefore(merger, merger->heap[child + 1], merger->heap[child])) {
+            child++;
+        }
+        if (!isReaderBefore(merger, merger->heap[child], reader)) {
+            break;
+        }
+        merger->heap[i] = merger->heap[child];
+        i = child;
+    }
+    merger->heap[i] = reader;
+}
+
+static void initKeyMerger(KeyMerger *merger) {
+    merger->numOfReaders = 0;
+    merger->heapSize = 0;
+}
+
+/* Returns false if the file could not be opened. */
+static bool addMergedFile(KeyMerger *merger, const char *path, int keySize) {
+    assert(merger->numOfReaders <= MAX_MERGE_FAN_IN);
+    if (!openKeyReader(&merger->readers[merger->numOfReaders], path, keySize)) {
+        return false;
+    }
+    merger->numOfReaders++;
+    return true;
+}
+
+/* Builds heap of readers, to be called once all files are added. */
+static void startKeyMerger(KeyMerger *merger) {
+    for (int i = 0; i < merger->numOfReaders; i++) {
+        if (merger->readers[i].hasKey) {
+            merger->heap[merger->heapSize] = i;
+            merger->heapSize++;
+        }
+    }
+    for (int i = merger->heapSize / 2 - 1; i >= 0; i--) {
+        siftDownReader(merger, i);
+    }
+}
+
+/* Copies the smallest key left to given buffer. Returns number of file it
+ * comes from or -1 if all files are read. */
+static int popMergedKey(KeyMerger *merger, unsigned char *key) {
+    if (merger->heapSize == 0) {
+        return -1;
+    }
+
+    int reader = merger->heap[0];
+    memcpy(key, merger->readers[reader].key, merger->readers[reader].keySize);
+    readNextKey(&merger->readers[reader]);
+    if (!merger->readers[reader].hasKey) {
+        merger->heapSize--;
+        merger->heap[0] = merger->heap[merger->heapSize];
+    }
+    if (merger->heapSize > 0) {
+        siftDownReader(merger, 0);
+    }
+    return reader;
+}
+
+/* Returns false if reading any of the files failed. */
+static bool disposeKeyMerger(KeyMerger *merger) {
+    bool isRead = true;
+    for (int i = 0; i < merger->numOfReaders; i++) {
+        if (!closeKeyReader(&merger->readers[i])) {
+            isRead = false;
+        }
+    }
+    return isRead;
+}
+
+struct ExternalSearch {
+    Solver solver;
+    StatePacker packer;
+    int keySize;
+    char directory[MAX_DIRECTORY_SIZE];
+    /* Bits of storage locations, laid out like chests of keys. */
+    unsigned char *goalKey;
+    /* Successors waiting to be sorted and written as a run. */
+    unsigned char *runKeys;
+    unsigned char *sortBuffer;
+    int runSize;
+    int runCapacity;
+    /* Numbers of run files, oldest first. */
+    int *runs;
+    int numOfRuns;
+    int runsCapacity;
+    int nextRunNum;
+};
+
+typedef struct ExternalSearch ExternalSearch;
+
+static void getLayerPath(ExternalSearch *search, int layer, char *path) {
+    snprintf(path, MAX_FILE_PATH_SIZE, "%s/layer-%d", search->directory, layer);
+}
+
+static void getVisitedPath(ExternalSearch *search, int layer, char *path) {
+    snprintf(path, MAX_FILE_PATH_SIZE, "%s/visited-%d", search->directory, layer);
+}
+
+static void getRunPath(ExternalSearch *search, int run, char *path) {
+    snprintf(path, MAX_FILE_PATH_SIZE, "%s/run-%d", search->directory, run);
+}
+
+static bool isSolvedKey(ExternalSearch *search, const unsigned char *key) {
+    for (int i = PACKED_PLAYER_SIZE; i < search->keySize; i++) {
+        if ((key[i] & ~search->goalKey[i]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void mergeKeys(const unsigned char *from, unsigned char *to, int low, int middle,
+                      int high, int keySize) {
+    int i = low;
+    int j = middle;
+    for (int k = low; k < high; k++) {
+        const unsigned char *key;
+        if (j == high || (i < middle && memcmp(from + (size_t) i * keySize,
+                                               from + (size_t) j * keySize, keySize) <= 0)) {
+            key = from + (size_t) i * keySize;
+            i++;
+        }
+        else {
+            key = from + (size_t) j * keySize;
+            j++;
+        }
+        memcpy(to + (size_t) k * keySize, key, keySize);
+    }
+}
+
+/* Bottom-up merge sort of keys of fixed size, buffer has to hold all of them. */
+static void sortKeys(unsigned char *keys, unsigned char *buffer, int numOfKeys,
+                     int keySize) {
+    unsigned char *from = keys;
+    unsigned char *to = buffer;
+    for (int width = 1; width < numOfKeys; width *= 2) {
+        for (int low = 0; low < numOfKeys; low += 2 * width) {
+            int middle = low + width < numOfKeys ? low + width : numOfKeys;
+            int high = low + 2 * width < numOfKeys ? low + 2 * width : numOfKeys;
+            mergeKeys(from, to, low, middle, high, keySize);
+        }
+        unsigned char *swapped = from;
+        from = to;
+        to = swapped;
+    }
+    if (from != keys) {
+        memcpy(keys, from, (size_t) numOfKeys * keySize);
+    }
+}
+
+static void addRun(ExternalSearch *search, int run) {
+    if (search->numOfRuns == search->runsCapacity) {
+        search->runsCapacity *= GROWTH_FACTOR;
+        search->runs = realloc(search->runs, search->runsCapacity * sizeof(int));
+        assert(search->runs != NULL);
+    }
+    search->runs[search->numOfRuns] = run;
+    search->numOfRuns++;
+}
+
+/* Sorts collected successors and writes them without duplicates as a run.
+ * Returns false if the run could not be written. */
+static bool flushRun(ExternalSearch *search) {
+    if (search->runSize == 0) {
+        return true;
+    }
+    sortKeys(search->runKeys, search->sortBuffer, search->runSize, search->keySize);
+
+    char path[MAX_FILE_PATH_SIZE];
+    getRunPath(search, search->nextRunNum, path);
+    KeyWriter writer;
+    if (!openKeyWriter(&writer, path, search->keySize)) {
+        return false;
+    }
+    for (int i = 0; i < search->runSize; i++) {
+        unsigned char *key = search->runKeys + (size_t) i * search->keySize;
+        if (i == 0 || memcmp(key - search->keySize, key, search->keySize) != 0) {
+            writeKey(&writer, key);
+        }
+    }
+    addRun(search, search->nextRunNum);
+    search->nextRunNum++;
+    search->runSize = 0;
+    return closeKeyWriter(&writer);
+}
+
+/* Returns false if reading the layer or writing runs failed. */
+static bool expandLayerToRuns(ExternalSearch *search, int layer) {
+    char path[MAX_FILE_PATH_SIZE];
+    getLayerPath(search, layer, path);
+    KeyReader reader;
+    if (!openKeyReader(&reader, path, search->keySize)) {
+        return false;
+    }
+
+    SearchState successors[MAX_NUM_OF_SUCCESSORS];
+    bool isWritten = true;
+    while (reader.hasKey && isWritten) {
+        SearchState state;
+        unpackSearchState(&search->packer, reader.key, &state);
+        int size = expandPushes(&search->solver, &state, successors);
+        for (int i = 0; i < size && isWritten; i++) {
+            if (search->runSize == search->runCapacity) {
+                isWritten = flushRun(search);
+            }
+            packSearchState(&search->packer, &successors[i], search->solver.numOfChests,
+                            search->runKeys + (size_t) search->runSize * search->keySize);
+            search->runSize++;
+        }
+        readNextKey(&reader);
+    }
+    if (isWritten) {
+        isWritten = flushRun(search);
+    }
+
+    return closeKeyReader(&reader) && isWritten;
+}
+
+/* Merges the oldest runs into a single one until all of them can be merged
+ * at once with the file of visited states. Returns false if reading
+ * or writing runs failed. */
+static bool mergeRunsInPasses(ExternalSearch *search) {
+    char path[MAX_FILE_PATH_SIZE];
+    unsigned char *key = malloc(search->keySize);
+    assert(key != NULL);
+
+    bool isMerged = true;
+    while (search->numOfRuns > MAX_MERGE_FAN_IN && isMerged) {
+        KeyMerger merger;
+        initKeyMerger(&merger);
+        for (int i = 0; i < MAX_MERGE_FAN_IN && isMerged; i++) {
+            getRunPath(search, search->runs[i], path);
+            isMerged = addMergedFile(&merger, path, search->keySize);
+        }
+        startKeyMerger(&merger);
+
+        getRunPath(search, search->nextRunNum, path);
+        KeyWriter writer;
+        if (isMerged && openKeyWriter(&writer, path, search->keySize)) {
+            while (popMergedKey(&merger, key) != -1) {
+                if (!writer.hasPrevious
+                    || memcmp(writer.previous, key, search->keySize) != 0) {
+                    writeKey(&writer, key);
+                }
+            }
+            isMerged = closeKeyWriter(&writer);
+        }
+        else {
+            isMerged = false;
+        }
+        if (!disposeKeyMerger(&merger)) {
+            isMerged = false;
+        }
+
+        for (int i = 0; i < MAX_MERGE_FAN_IN; i++) {
+            getRunPath(search, search->runs[i], path);
+            unlink(path);
+        }
+        search->numOfRuns -= MAX_MERGE_FAN_IN;
+        memmove(search->runs, search->runs + MAX_MERGE_FAN_IN,
+                search->numOfRuns * sizeof(int));
+        addRun(search, search->nextRunNum);
+        search->nextRunNum++;
+    }
+
+    free(key);
+    return isMerged;
+}
+
+/* Merges runs with visited states of given layer, writing visited states
+ * of the next layer and states of the next layer which were not visited
+ * before. Stops at the first solved state, copying it to solvedKey.
+ * Sets number of states of the next layer. Returns false if reading
+ * or writing any of the files failed. */
+static bool mergeRunsWithVisited(ExternalSearch *search, int layer,
+                                 unsigned char *solvedKey, bool *isSolved,
+                                 long long *numOfStates) {
+    char path[MAX_FILE_PATH_SIZE];
+    KeyMerger merger;
+    initKeyMerger(&merger);
+    bool isOpened = true;
+    for (int i = 0; i < search->numOfRuns && isOpened; i++) {
+        getRunPath(search, search->runs[i], path);
+        isOpened = addMergedFile(&merger, path, search->keySize);
+    }
+    int visitedReader = merger.numOfReaders;
+    getVisitedPath(search, layer, path);
+    isOpened = isOpened && addMergedFile(&merger, path, search->keySize);
+
+    KeyWriter visitedWriter;
+    getVisitedPath(search, layer + 1, path);
+    bool isVisitedOpened = isOpened && openKeyWriter(&visitedWriter, path, search->keySize);
+    KeyWriter layerWriter;
+    getLayerPath(search, layer + 1, path);
+    bool isLayerOpened = isVisitedOpened
+                         && openKeyWriter(&layerWriter, path, search->keySize);
+    if (!isLayerOpened) {
+        if (isVisitedOpened) {
+            closeKeyWriter(&visitedWriter);
+        }
+        disposeKeyMerger(&merger);
+        return false;
+    }
+    startKeyMerger(&merger);
+
+    /* Equal keys come one after another, key is new if none of them
+     * comes from visited states. */
+    unsigned char *key = malloc(search->keySize);
+    assert(key != NULL);
+    unsigned char *groupKey = malloc(search->keySize);
+    assert(groupKey != NULL);
+    bool hasGroup = false;
+    bool isGroupVisited = false;
+    *isSolved = false;
+    int reader = popMergedKey(&merger, key);
+    while (!*isSolved && (hasGroup || reader != -1)) {
+        if (reader != -1 && hasGroup && memcmp(key, groupKey, search->keySize) == 0) {
+            isGroupVisited = isGroupVisited || reader == visitedReader;
+            reader = popMergedKey(&merger, key);
+            continue;
+        }
+
+        if (hasGroup) {
+            writeKey(&visitedWriter, groupKey);
+            if (!isGroupVisited) {
+                writeKey(&layerWriter, groupKey);
+                if (isSolvedKey(search, groupKey)) {
+                    memcpy(solvedKey, groupKey, search->keySize);
+                    *isSolved = true;
+                }
+            }
+        }
+        hasGroup = reader != -1;
+        if (hasGroup) {
+            memcpy(groupKey, key, search->keySize);
+            isGroupVisited = reader == visitedReader;
+            reader = popMergedKey(&merger, key);
+        }
+    }
+    *numOfStates = layerWriter.numOfKeys;
+
+    free(groupKey);
+    free(key);
+    bool isMerged = closeKeyWriter(&layerWriter);
+    isMerged = closeKeyWriter(&visitedWriter) && isMerged;
+    isMerged = disposeKeyMerger(&merger) && isMerged;
+
+    for (int i = 0; i < search->numOfRuns; i++) {
+        getRunPath(search, search->runs[i], path);
+        unlink(path);
+    }
+    search->numOfRuns = 0;
+    getVisitedPath(search, layer, path);
+    unlink(path);
+    return isMerged;
+}
+
+/* Finds state of given layer which has the state of given key as a successor
+ * and overwrites the key with its key. Returns false if the layer could not
+ * be read, so there is no such state in it. */
+static bool findPredecessor(ExternalSearch *search, int layer, unsigned char *key,
+                            SearchState *predecessor) {
+    char path[MAX_FILE_PATH_SIZE];
+    getLayerPath(search, layer, path);
+    KeyReader reader;
+    if (!openKeyReader(&reader, path, search->keySize)) {
+        return false;
+    }
+
+    unsigned char *successorKey = malloc(search->keySize);
+    assert(successorKey != NULL);
+    SearchState successors[MAX_NUM_OF_SUCCESSORS];
+    bool isFound = false;
+    while (reader.hasKey && !isFound) {
+        unpackSearchState(&search->packer, reader.key, predecessor);
+        int size = expandPushes(&search->solver, predecessor, successors);
+        for (int i = 0; i < size && !isFound; i++) {
+            packSearchState(&search->packer, &successors[i], search->solver.numOfChests,
+                            successorKey);
+            isFound = memcmp(successorKey, key, search->keySize) == 0;
+        }
+        if (isFound) {
+            memcpy(key, reader.key, search->keySize);
+        }
+        readNextKey(&reader);
+    }
+
+    free(successorKey);
+    return closeKeyReader(&reader) && isFound;
+}
+
+/* Returns false if path could not be found, because layers could not be read. */
+static bool addSolutionCommands(ExternalSearch *search, Game *game, int numOfLayers,
+                                unsigned char *solvedKey, CommandList *solution) {
+    SearchState *path = malloc(numOfLayers * sizeof(SearchState));
+    assert(path != NULL);
+    unpackSearchState(&search->packer, solvedKey, &path[numOfLayers - 1]);
+    for (int layer = numOfLayers - 2; layer >= 0; layer--) {
+        if (!findPredecessor(search, layer, solvedKey, &path[layer])) {
+            free(path);
+            return false;
+        }
+    }
+
+    int *chestAtCell = malloc(search->solver.numOfCells * sizeof(int));
+    assert(chestAtCell != NULL);
+    initChestAtCell(&search->solver, game, chestAtCell);
+    for (int i = 0; i + 1 < numOfLayers; i++) {
+        addStepCommands(&search->solver, &path[i], &path[i + 1], chestAtCell, solution);
+    }
+
+    free(chestAtCell);
+    free(path);
+    return true;
+}
+
+static void initExternalSearch(ExternalSearch *search, long long memoryBudget) {
+    initStatePacker(&search->packer, &search->solver);
+    search->keySize = search->packer.keySize;
+
+    search->goalKey = calloc(search->keySize, 1);
+    assert(search->goalKey != NULL);
+    for (int i = 0; i < search->solver.numOfCells; i++) {
+        if (isFloorSearchCell(&search->solver, i) && isGoalSearchCell(&search->solver, i)) {
+            int goal = search->packer.floorNums[i];
+            search->goalKey[PACKED_PLAYER_SIZE + goal / BITS_IN_BYTE] |=
+                    1 << (goal % BITS_IN_BYTE);
+        }
+    }
+
+    /* Budget left after buffers of merged files is split between keys
+     * of a run and buffer for sorting them. */
+    long long runBudget = memoryBudget - (MAX_MERGE_FAN_IN + 3) * KEY_FILE_BUFFER_SIZE;
+    long long runCapacity = runBudget / (2 * search->keySize);
+    if (runCapacity < MIN_RUN_CAPACITY) {
+        runCapacity = MIN_RUN_CAPACITY;
+    }
+    if (runCapacity > INT32_MAX / 2) {
+        runCapacity = INT32_MAX / 2;
+    }
+    search->runCapacity = (int) runCapacity;
+    search->runSize = 0;
+    search->runKeys = malloc((size_t) search->runCapacity * search->keySize);
+    assert(search->runKeys != NULL);
+    search->sortBuffer = malloc((size_t) search->runCapacity * search->keySize);
+    assert(search->sortBuffer != NULL);
+
+    search->runsCapacity = INITIAL_CAPACITY;
+    search->runs = malloc(search->runsCapacity * sizeof(int));
+    assert(search->runs != NULL);
+    search->numOfRuns = 0;
+    search->nextRunNum = 0;
+}
+
+static void disposeExternalSearch(ExternalSearch *search) {
+    free(search->goalKey);
+    free(search->runKeys);
+    free(search->sortBuffer);
+    free(search->runs);
+    disposeStatePacker(&search->packer);
+}
+
+/* Writes file holding only given key. Returns false if it failed. */
+static bool writeSingleKeyFile(const char *path, const unsigned char *key, int keySize) {
+    KeyWriter writer;
+    if (!openKeyWriter(&writer, path, keySize)) {
+        return false;
+    }
+    writeKey(&writer, key);
+    return closeKeyWriter(&writer);
+}
+
+/* Removes all files the search could have created and its directory. */
+static void removeSearchFiles(ExternalSearch *search, int numOfLayers) {
+    char path[MAX_FILE_PATH_SIZE];
+    for (int i = 0; i < numOfLayers; i++) {
+        getLayerPath(search, i, path);
+        unlink(path);
+        getVisitedPath(search, i, path);
+        unlink(path);
+    }
+    for (int i = 0; i < search->nextRunNum; i++) {
+        getRunPath(search, i, path);
+        unlink(path);
+    }
+    rmdir(search->directory);
+}
+
+bool solveGameOnDisk(Game *game, CommandList *solution, long long memoryBudget,
+                     const char *directory) {
+    ExternalSearch search;
+    if (!initSolver(&search.solver, game)) {
+        return false;
+    }
+    if (snprintf(search.directory, MAX_DIRECTORY_SIZE, "%s/sokoban-XXXXXX", directory)
+        >= MAX_DIRECTORY_SIZE) {
+        fprintf(stderr, "Directory path is too long: %s\n", directory);
+        disposeSolver(&search.solver);
+        return false;
+    }
+    if (mkdtemp(search.directory) == NULL) {
+        perror("mkdtemp");
+        disposeSolver(&search.solver);
+        return false;
+    }
+    initExternalSearch(&search, memoryBudget);
+
+    unsigned char *solvedKey = malloc(search.keySize);
+    assert(solvedKey != NULL);
+    SearchState start;
+    getGameSearchState(&search.solver, game, &start);
+    packSearchState(&search.packer, &start, search.solver.numOfChests, solvedKey);
+
+    char path[MAX_FILE_PATH_SIZE];
+    getLayerPath(&search, 0, path);
+    bool isWorking = writeSingleKeyFile(path, solvedKey, search.keySize);
+    getVisitedPath(&search, 0, path);
+    isWorking = isWorking && writeSingleKeyFile(path, solvedKey, search.keySize);
+
+    bool isSolved = isSolvedKey(&search, solvedKey);
+    int layer = 0;
+    long long numOfStates = 1;
+    while (isWorking && !isSolved && numOfStates > 0) {
+        isWorking = expandLayerToRuns(&search, layer)
+                    && mergeRunsInPasses(&search)
+                    && mergeRunsWithVisited(&search, layer, solvedKey, &isSolved,
+                                            &numOfStates);
+        layer++;
+    }
+
+    if (isWorking && isSolved) {
+        isWorking = addSolutionCommands(&search, game, layer + 1, solvedKey, solution);
+    }
+    if (!isWorking) {
+        fprintf(stderr, "Search files in %s could not be written or read\n",
+                search.directory);
+    }
+
+    removeSearchFiles(&search, layer + 2);
+    free(solvedKey);
+    disposeExternalSearch(&search);
+    disposeSolver(&search.solver);
+    return isWorking && isSolved;
+}
@@ -0,0 +1,48 @@
+#ifndef EXTERNAL_SEARCH_H
+#define EXTERNAL_SEARCH_H
+
+#include <stdio.h>
+
+#include "packed_state.h"
+
+#define DEFAULT_EXTERNAL_MEMORY_BUDGET_MB 256
+#define DEFAULT_EXTERNAL_DIRECTORY "/tmp"
+#define BYTES_IN_MEGABYTE (1024LL * 1024LL)
+
+/* Sequential reading and writing of files of sorted packed keys. Keys are
+ * front coded: each one is stored as length of prefix shared with the
+ * previous key, two bytes in big endian order, followed by the rest of it. */
+struct KeyWriter {
+    FILE *file;
+    unsigned char *previous;
+    int keySize;
+    bool hasPrevious;
+    long long numOfKeys;
+};
+
+typedef struct KeyWriter KeyWriter;
+
+struct KeyReader {
+    FILE *file;
+    unsigned char *key;
+    int keySize;
+    bool hasKey;
+    bool isCorrupted;
+};
+
+typedef struct KeyReader KeyReader;
+
+/* Finds solution with the least number of steps, each a single push or
+ * a macro push, by breadth-first search keeping states on disk, in files
+ * created in a temporary subdirectory of given directory. Each layer is
+ * expanded into sorted runs of successors fitting into memory budget given
+ * in bytes, the runs are merged and duplicates are removed by merging them
+ * with the file of all states visited so far, which is updated at the same
+ * time (delayed duplicate detection). Files are only read and written
+ * sequentially. Path is found by scanning layers backwards for predecessors.
+ * Returns false if there is no solution or the files could not be created,
+ * written or read. */
+bool solveGameOnDisk(Game *game, CommandList *solution, long long memoryBudget,
+                     const char *directory);
+
+#endif // EXTERNAL_SEARCH_H
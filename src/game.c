@@ -33,6 +33,19 @@ void findPlayerPosition(Game *game, Position *playerPos) {
     }
 }
 
+/* Binds game to already loaded board and finds chests and player on it. */
+void initGame(Game *game, Board *board, Position *playerPos) {
+    game->board = board;
+    game->analysis = NULL;
+    selectEngine(&game->engine, board);
+
+    initChestsPositions(game->chestsPos);
+    findChestsPositions(game);
+
+    findPlayerPosition(game, playerPos);
+    game->playerPos = playerPos;
+}
+
 void markSquareVisited(Game *game, Position *pos) {
     if (getSquare(game, pos) == BLANK_SQUARE) {
         setSquare(game, pos, VISITED_BLANK_SQUARE);
@@ -132,41 +145,92 @@ void executeUndoCommand(Game *game, MoveStack *stack) {
     Position *currPlayerPos = game->playerPos;
     Position *pastPlayerPos = pastMove->prevPlayerPos;
 
+    Position pastChestPos = *currChestPos;
     setCurrentChestSquareToBlankSquare(game, currChestPos);
-    setCurrentPlayerSquareToChestSquare(game, currPlayerPos, pastMove->chestNum);
-    setCurrentBlankSquareToPlayerSquare(game, pastPlayerPos);
+    setCurrentPlayerSquareToBlankSquare(game, currPlayerPos);
 
-    currChestPos->row = currPlayerPos->row;
-    currChestPos->col = currPlayerPos->col;
+    char backward = getOppositeDirection(pastMove->direction);
+    for (int i = 0; i < pastMove->numOfPushes; i++) {
+        currChestPos->row = getPushedChestRowNumber(currChestPos->row, backward);
+        currChestPos->col = getPushedChestColNumber(currChestPos->col, backward);
+    }
+    setCurrentBlankSquareToChestSquare(game, currChestPos, pastMove->chestNum);
+    moveChestInEngine(&game->engine, &pastChestPos, currChestPos);
 
     currPlayerPos->row = pastPlayerPos->row;
     currPlayerPos->col = pastPlayerPos->col;
+    setCurrentBlankSquareToPlayerSquare(game, currPlayerPos);
 
     disposeMove(pastMove);
 }
 
-void executePushCommand(Game *game, PushCommand *pushComm, MoveStack *stack) {
+/* Pushes chest numOfPushes times in the same direction, player follows it.
+ * All pushes are reverted by a single undo. */
+void executeMultiplePushCommand(Game *game, PushCommand *pushComm, int numOfPushes,
+                                MoveStack *stack) {
     Position *currPlayerPos = game->playerPos;
     Position *currChestPos = getChestPosition(game, pushComm->chestNum);
 
+    Position pastChestPos = *currChestPos;
     setCurrentPlayerSquareToBlankSquare(game, currPlayerPos);
-    setCurrentChestSquareToPlayerSquare(game, currChestPos);
+    setCurrentChestSquareToBlankSquare(game, currChestPos);
 
-    push(stack, getNewMove(pushComm->chestNum,
+    push(stack, getNewMove(pushComm->chestNum, pushComm->direction, numOfPushes,
                            getNewPosition(currPlayerPos->row, currPlayerPos->col)));
 
-    currPlayerPos->row = currChestPos->row;
-    currPlayerPos->col = currChestPos->col;
+    for (int i = 0; i < numOfPushes; i++) {
+        currPlayerPos->row = currChestPos->row;
+        currPlayerPos->col = currChestPos->col;
 
-    currChestPos->row = getPushedChestRowNumber(currChestPos->row,
-                                                pushComm->direction);
-    currChestPos->col = getPushedChestColNumber(currChestPos->col,
-                                                pushComm->direction);
+        currChestPos->row = getPushedChestRowNumber(currChestPos->row,
+                                                    pushComm->direction);
+        currChestPos->col = getPushedChestColNumber(currChestPos->col,
+                                                    pushComm->direction);
+    }
 
+    setCurrentBlankSquareToPlayerSquare(game, currPlayerPos);
     setCurrentBlankSquareToChestSquare(game, currChestPos, pushComm->chestNum);
+    moveChestInEngine(&game->engine, &pastChestPos, currChestPos);
+}
+
+void executePushCommand(Game *game, PushCommand *pushComm, MoveStack *stack) {
+    executeMultiplePushCommand(game, pushComm, 1, stack);
+}
+
+LevelAnalysis *getLevelAnalysis(Game *game) {
+    if (game->analysis == NULL) {
+        game->analysis = malloc(sizeof(LevelAnalysis));
+        assert(game->analysis != NULL);
+        analyzeLevel(game->analysis, game->board);
+    }
+    return game->analysis;
+}
+
+static bool isSquareFreeForChest(void *context, int row, int col) {
+    Game *game = context;
+    Position pos;
+    pos.row = row;
+    pos.col = col;
+    return isPositionInRange(game->board, &pos) && isLegalSquare(getSquare(game, &pos));
+}
+
+/* Number of pushes done by macro push command, which is assumed
+ * to be possible. */
+int getMacroPushCommandLength(Game *game, PushCommand *pushComm) {
+    return getMacroPushLength(getLevelAnalysis(game),
+                              getChestPosition(game, pushComm->chestNum),
+                              pushComm->direction, isSquareFreeForChest, game);
+}
+
+void executeMacroPushCommand(Game *game, PushCommand *pushComm, MoveStack *stack) {
+    executeMultiplePushCommand(game, pushComm, getMacroPushCommandLength(game, pushComm), stack);
 }
 
 bool doesPathExist(Game *game, Position *targetPlayerPos) {
+    if (!isDynamicEngine(&game->engine)) {
+        return isReachableInEngine(&game->engine, game->playerPos, targetPlayerPos);
+    }
+
     PositionQueue queue;
     initPositionQueue(&queue);
 
@@ -7,11 +7,17 @@
 #include "position_queue.h"
 #include "command.h"
 #include "move_stack.h"
+#include "level_analysis.h"
+#include "engine.h"
 
 struct Game {
     Board *board;
     Position *playerPos;
     Position *chestsPos[NUM_OF_CHESTS];
+    /* Computed on first use, see getLevelAnalysis. */
+    LevelAnalysis *analysis;
+    /* Chosen by size of the board when the game is initialized. */
+    Engine engine;
 };
 
 typedef struct Game Game;
@@ -20,6 +26,8 @@ void findChestsPositions(Game *game);
 
 void findPlayerPosition(Game *game, Position *playerPos);
 
+void initGame(Game *game, Board *board, Position *playerPos);
+
 void markSquareVisited(Game *game, Position *pos);
 
 void unmarkSquareIfVisited(Game *game, Position *pos);
@@ -34,8 +42,17 @@ void initTargetChestPosition(Game *game, PushCommand *pushComm,
 
 void executeUndoCommand(Game *game, MoveStack *stack);
 
+void executeMultiplePushCommand(Game *game, PushCommand *pushComm, int numOfPushes,
+                                MoveStack *stack);
+
 void executePushCommand(Game *game, PushCommand *pushComm, MoveStack *stack);
 
+LevelAnalysis *getLevelAnalysis(Game *game);
+
+int getMacroPushCommandLength(Game *game, PushCommand *pushComm);
+
+void executeMacroPushCommand(Game *game, PushCommand *pushComm, MoveStack *stack);
+
 bool doesPathExist(Game *game, Position *targetPlayerPos);
 
 static inline char getSquare(Game *game, Position *pos) {
@@ -61,18 +78,6 @@ static inline void setCurrentChestSquareToBlankSquare(Game *game,
     }
 }
 
-static inline void setCurrentPlayerSquareToChestSquare(Game *game,
-                                                       Position *currPlayerPos,
-                                                       int chestNum) {
-    if (getSquare(game, currPlayerPos) == PLAYER_SQUARE) {
-        setSquare(game, currPlayerPos, getChestName(chestNum, PLAYER_SQUARE));
-    }
-    else {
-        /* getSquare(game, currPlayerPos) is equal to FINAL_PLAYER_SQUARE. */
-        setSquare(game, currPlayerPos, getChestName(chestNum, FINAL_PLAYER_SQUARE));
-    }
-}
-
 static inline void setCurrentBlankSquareToPlayerSquare(Game *game,
                                                        Position *pastPlayerPos) {
     if (getSquare(game, pastPlayerPos) == BLANK_SQUARE) {
@@ -95,17 +100,6 @@ static inline void setCurrentPlayerSquareToBlankSquare(Game *game,
     }
 }
 
-static inline void setCurrentChestSquareToPlayerSquare(Game *game,
-                                                       Position *currChestPos) {
-    if (isFinalChestSquare(getSquare(game, currChestPos))) {
-        setSquare(game, currChestPos, FINAL_PLAYER_SQUARE);
-    }
-    else {
-        /* getSquare(game, currChestPos) is a non-final chest square. */
-        setSquare(game, currChestPos, PLAYER_SQUARE);
-    }
-}
-
 static inline void setCurrentBlankSquareToChestSquare(Game *game,
                                                       Position *targetChestPos,
                                                       int chestNum) {
@@ -152,6 +146,9 @@ static inline void addNeighborsIfLegal(Game *game, Position *pos,
 static inline bool isChestPushPossible(Game *game, PushCommand *pushComm) {
     Position targetChestPos;
     initTargetChestPosition(game, pushComm, &targetChestPos);
+    if (!isDynamicEngine(&game->engine)) {
+        return isFreeInEngine(&game->engine, &targetChestPos);
+    }
     return isPositionInRange(game->board, &targetChestPos) &&
            isLegalSquare(getSquare(game, &targetChestPos));
 }
@@ -172,6 +169,10 @@ static inline bool isPushCommandPossible(Game *game, PushCommand *pushComm) {
 static inline void disposeGame(Game *game) {
     disposeBoard(game->board);
     disposeChestsPositions(game->chestsPos);
+    if (game->analysis != NULL) {
+        disposeLevelAnalysis(game->analysis);
+        free(game->analysis);
+    }
 }
 
 #endif // GAME_H
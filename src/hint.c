@@ -0,0 +1,443 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "hint.h"
+
+#define HINT_HEURISTIC_WEIGHT 2
+#define HINT_INITIAL_CAPACITY 1024
+#define HINT_GROWTH_FACTOR 2
+/* Clock is checked once per this many expansions. */
+#define HINT_CLOCK_CHECK_PERIOD 64
+/* Hints following the first one get this fraction of the time budget,
+ * as they start with states explored by the previous searches. */
+#define HINT_FOLLOWING_BUDGET_DIVISOR 20
+/* When the table is full, it is compacted to at most this fraction of its
+ * limit, so that search has room to go on. */
+#define HINT_COMPACTED_DIVISOR 2
+#define NANOSECONDS_IN_MILLISECOND 1000000LL
+
+static long long getMonotonicTime() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 * NANOSECONDS_IN_MILLISECOND + ts.tv_nsec;
+}
+
+static void initHintStorage(HintSearch *hints) {
+    initStateTable(&hints->table, hints->solver.numOfChests);
+    hints->nodesCapacity = HINT_INITIAL_CAPACITY;
+    hints->nodes = malloc(hints->nodesCapacity * sizeof(HintNode));
+    assert(hints->nodes != NULL);
+    hints->childrenSize = 0;
+    hints->childrenCapacity = HINT_INITIAL_CAPACITY;
+    hints->children = malloc(hints->childrenCapacity * sizeof(int));
+    assert(hints->children != NULL);
+    hints->heapSize = 0;
+    hints->heapCapacity = HINT_INITIAL_CAPACITY;
+    hints->heap = malloc(hints->heapCapacity * sizeof(HeapItem));
+    assert(hints->heap != NULL);
+    hints->stamp = 0;
+    hints->root = NO_NODE;
+    hints->numOfSearches = 0;
+}
+
+static void disposeHintStorage(HintSearch *hints) {
+    disposeStateTable(&hints->table);
+    free(hints->nodes);
+    free(hints->children);
+    free(hints->heap);
+}
+
+/* Returns node of given state, adding it to the table if it is new. */
+static int getHintNode(HintSearch *hints, SearchState *state) {
+    int node = findState(&hints->table, state);
+    if (node != -1) {
+        return node;
+    }
+
+    node = addState(&hints->table, state, NO_PARENT);
+    if (node == hints->nodesCapacity) {
+        hints->nodesCapacity *= HINT_GROWTH_FACTOR;
+        hints->nodes = realloc(hints->nodes, hints->nodesCapacity * sizeof(HintNode));
+        assert(hints->nodes != NULL);
+    }
+
+    HintNode *hintNode = &hints->nodes[node];
+    hintNode->heuristic = getSearchStateHeuristic(&hints->solver, state);
+    hintNode->firstChild = NO_NODE;
+    hintNode->numOfChildren = 0;
+    hintNode->next = NO_NODE;
+    hintNode->distance = isSolvedSearchState(&hints->solver, state) ? 0 : NO_DISTANCE;
+    hintNode->openStamp = 0;
+    hintNode->closedStamp = 0;
+    return node;
+}
+
+static void addChild(HintSearch *hints, int child) {
+    if (hints->childrenSize == hints->childrenCapacity) {
+        hints->childrenCapacity *= HINT_GROWTH_FACTOR;
+        hints->children = realloc(hints->children, hints->childrenCapacity * sizeof(int));
+        assert(hints->children != NULL);
+    }
+    hints->children[hints->childrenSize] = child;
+    hints->childrenSize++;
+}
+
+static void expandHintNode(HintSearch *hints, int node) {
+    if (hints->nodes[node].firstChild != NO_NODE) {
+        return;
+    }
+
+    SearchState state = *getTableState(&hints->table, node);
+    SearchState successors[MAX_NUM_OF_SUCCESSORS];
+    int size = expandPushes(&hints->solver, &state, successors);
+
+    int children[MAX_NUM_OF_SUCCESSORS];
+    for (int i = 0; i < size; i++) {
+        children[i] = getHintNode(hints, &successors[i]);
+    }
+    hints->nodes[node].firstChild = hints->childrenSize;
+    hints->nodes[node].numOfChildren = size;
+    for (int i = 0; i < size; i++) {
+        addChild(hints, children[i]);
+    }
+}
+
+static void pushToHeap(HintSearch *hints, int priority, int node) {
+    if (hints->heapSize == hints->heapCapacity) {
+        hints->heapCapacity *= HINT_GROWTH_FACTOR;
+        hints->heap = realloc(hints->heap, hints->heapCapacity * sizeof(HeapItem));
+        assert(hints->heap != NULL);
+    }
+
+    int i = hints->heapSize;
+    hints->heapSize++;
+    while (i > 0 && hints->heap[(i - 1) / 2].priority > priority) {
+        hints->heap[i] = hints->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    hints->heap[i].priority = priority;
+    hints->heap[i].node = node;
+}
+
+static int popFromHeap(HintSearch *hints) {
+    int node = hints->heap[0].node;
+    hints->heapSize--;
+    HeapItem last = hints->heap[hints->heapSize];
+
+    int i = 0;
+    while (2 * i + 1 < hints->heapSize) {
+        int child = 2 * i + 1;
+        if (child + 1 < hints->heapSize
+            && hints->heap[child + 1].priority < hints->heap[child].priority) {
+            child++;
+        }
+        if (hints->heap[child].priority >= last.priority) {
+            break;
+        }
+        hints->heap[i] = hints->heap[child];
+        i = child;
+    }
+    hints->heap[i] = last;
+    return node;
+}
+
+static int getPriority(HintNode *node) {
+    if (node->distance != NO_DISTANCE) {
+        return node->cost + node->distance;
+    }
+    return node->cost + HINT_HEURISTIC_WEIGHT * node->heuristic;
+}
+
+static bool isDeadHintNode(HintNode *node) {
+    return node->heuristic == NO_DISTANCE;
+}
+
+static void openHintNode(HintSearch *hints, int node, int cost, int parent) {
+    HintNode *hintNode = &hints->nodes[node];
+    if (isDeadHintNode(hintNode)
+        || (hintNode->openStamp == hints->stamp && hintNode->cost <= cost)) {
+        return;
+    }
+    hintNode->openStamp = hints->stamp;
+    hintNode->cost = cost;
+    hintNode->parent = parent;
+    pushToHeap(hints, getPriority(hintNode), node);
+}
+
+/* Remembers path found by the current search, from the root to the goal
+ * node which is solved or already has a known path. */
+static void markPathToSolution(HintSearch *hints, int goal) {
+    int child = goal;
+    for (int node = hints->nodes[goal].parent; node != NO_NODE;
+         node = hints->nodes[node].parent) {
+        HintNode *hintNode = &hints->nodes[node];
+        int distance = hints->nodes[child].distance + 1;
+        if (hintNode->distance == NO_DISTANCE || distance < hintNode->distance) {
+            hintNode->next = child;
+            hintNode->distance = distance;
+        }
+        child = node;
+    }
+}
+
+/* Returns the child of the root on the path from it to given node. */
+static int getFirstStep(HintSearch *hints, int node) {
+    while (node != NO_NODE && hints->nodes[node].parent != hints->root) {
+        node = hints->nodes[node].parent;
+    }
+    return node;
+}
+
+/* Tells if path to solution known from given kept node leads through kept
+ * nodes only. Nodes along the path are resolved at the same time, states
+ * are NO_NODE for unresolved ones, 0 for broken and 1 for kept paths. */
+static bool isKeptPath(HintSearch *hints, int node, int *newNodes, int *pathStates,
+                       int *stack) {
+    int size = 0;
+    bool isKept = false;
+    while (true) {
+        if (pathStates[node] != NO_NODE) {
+            isKept = pathStates[node] == 1;
+            break;
+        }
+        if (hints->nodes[node].distance == 0) {
+            isKept = true;
+            break;
+        }
+        int next = hints->nodes[node].next;
+        stack[size] = node;
+        size++;
+        if (next == NO_NODE || newNodes[next] == NO_NODE) {
+            break;
+        }
+        /* Marked as broken until resolved, which also stops at cycles. */
+        pathStates[node] = 0;
+        node = next;
+    }
+    for (int i = 0; i < size; i++) {
+        pathStates[stack[i]] = isKept ? 1 : 0;
+    }
+    return isKept;
+}
+
+/* Keeps only nodes reachable from the root through known children, nearest
+ * first, up to a fraction of the table limit. Children of nodes which were
+ * not all kept are expanded again when needed, paths to solution through
+ * evicted nodes are forgotten, states known to be dead stay dead. */
+static void compactHintStorage(HintSearch *hints) {
+    int oldSize = hints->table.size;
+    int limit = DEFAULT_MAX_NUM_OF_STATES / HINT_COMPACTED_DIVISOR;
+    int *newNodes = malloc(oldSize * sizeof(int));
+    assert(newNodes != NULL);
+    int *oldNodes = malloc(oldSize * sizeof(int));
+    assert(oldNodes != NULL);
+    for (int i = 0; i < oldSize; i++) {
+        newNodes[i] = NO_NODE;
+    }
+
+    newNodes[hints->root] = 0;
+    oldNodes[0] = hints->root;
+    int size = 1;
+    for (int i = 0; i < size; i++) {
+        HintNode *hintNode = &hints->nodes[oldNodes[i]];
+        for (int j = 0; j < hintNode->numOfChildren && size < limit; j++) {
+            int child = hints->children[hintNode->firstChild + j];
+            if (newNodes[child] == NO_NODE) {
+                newNodes[child] = size;
+                oldNodes[size] = child;
+                size++;
+            }
+        }
+    }
+
+    int *pathStates = malloc(oldSize * sizeof(int));
+    assert(pathStates != NULL);
+    int *stack = malloc(oldSize * sizeof(int));
+    assert(stack != NULL);
+    for (int i = 0; i < oldSize; i++) {
+        pathStates[i] = NO_NODE;
+    }
+
+    HintSearch compacted = *hints;
+    initHintStorage(&compacted);
+    compacted.numOfSearches = hints->numOfSearches;
+    compacted.stamp = hints->stamp;
+    for (int i = 0; i < size; i++) {
+        int node = getHintNode(&compacted, getTableState(&hints->table, oldNodes[i]));
+        HintNode *hintNode = &compacted.nodes[node];
+        HintNode *oldNode = &hints->nodes[oldNodes[i]];
+        hintNode->heuristic = oldNode->heuristic;
+        if (isKeptPath(hints, oldNodes[i], newNodes, pathStates, stack)) {
+            hintNode->next = oldNode->next == NO_NODE ? NO_NODE : newNodes[oldNode->next];
+            hintNode->distance = oldNode->distance;
+        }
+
+        bool areChildrenKept = oldNode->firstChild != NO_NODE;
+        for (int j = 0; j < oldNode->numOfChildren && areChildrenKept; j++) {
+            areChildrenKept = newNodes[hints->children[oldNode->firstChild + j]] != NO_NODE;
+        }
+        if (areChildrenKept) {
+            hintNode->firstChild = compacted.childrenSize;
+            hintNode->numOfChildren = oldNode->numOfChildren;
+            for (int j = 0; j < oldNode->numOfChildren; j++) {
+                addChild(&compacted, newNodes[hints->children[oldNode->firstChild + j]]);
+            }
+        }
+    }
+    compacted.root = 0;
+
+    disposeHintStorage(hints);
+    *hints = compacted;
+    free(newNodes);
+    free(oldNodes);
+    free(pathStates);
+    free(stack);
+}
+
+/* Marks all states closed by the current search as dead. Called when the
+ * search ran out of states to open, so none of them leads to solution. */
+static void markClosedNodesDead(HintSearch *hints) {
+    for (int i = 0; i < hints->table.size; i++) {
+        if (hints->nodes[i].closedStamp == hints->stamp) {
+            hints->nodes[i].heuristic = NO_DISTANCE;
+        }
+    }
+}
+
+/* Runs best-first search from the root until it finds a path to solution,
+ * runs out of time or states. Returns the child of the root to go to,
+ * on a path to solution if it was found or towards the most promising
+ * state otherwise, NO_NODE if the search showed there is no solution. */
+static int searchFromRoot(HintSearch *hints) {
+    if (hints->table.size >= DEFAULT_MAX_NUM_OF_STATES) {
+        compactHintStorage(hints);
+    }
+    long long timeBudget = hints->timeBudget;
+    if (hints->numOfSearches > 0) {
+        timeBudget /= HINT_FOLLOWING_BUDGET_DIVISOR;
+    }
+    hints->numOfSearches++;
+    long long deadline = getMonotonicTime() + timeBudget * NANOSECONDS_IN_MILLISECOND;
+    hints->stamp++;
+    hints->heapSize = 0;
+    openHintNode(hints, hints->root, 0, NO_NODE);
+
+    int best = hints->root;
+    int numOfExpansions = 0;
+    while (hints->heapSize > 0 && hints->table.size < DEFAULT_MAX_NUM_OF_STATES) {
+        numOfExpansions++;
+        if (numOfExpansions % HINT_CLOCK_CHECK_PERIOD == 0
+            && getMonotonicTime() > deadline) {
+            break;
+        }
+
+        int node = popFromHeap(hints);
+        if (hints->nodes[node].closedStamp == hints->stamp) {
+            continue;
+        }
+        hints->nodes[node].closedStamp = hints->stamp;
+
+        if (hints->nodes[node].distance != NO_DISTANCE) {
+            markPathToSolution(hints, node);
+            return hints->nodes[hints->root].next;
+        }
+        if (hints->nodes[node].heuristic < hints->nodes[best].heuristic) {
+            best = node;
+        }
+
+        expandHintNode(hints, node);
+        int cost = hints->nodes[node].cost + 1;
+        int firstChild = hints->nodes[node].firstChild;
+        for (int i = 0; i < hints->nodes[node].numOfChildren; i++) {
+            openHintNode(hints, hints->children[firstChild + i], cost, node);
+        }
+    }
+
+    if (hints->heapSize == 0) {
+        markClosedNodesDead(hints);
+        return NO_NODE;
+    }
+
+    if (best == hints->root) {
+        /* Nothing better found yet, any child which is not dead is as good
+         * as the others. */
+        HintNode *root = &hints->nodes[hints->root];
+        for (int i = 0; i < root->numOfChildren; i++) {
+            int child = hints->children[root->firstChild + i];
+            if (!isDeadHintNode(&hints->nodes[child])) {
+                return child;
+            }
+        }
+        return NO_NODE;
+    }
+    return getFirstStep(hints, best);
+}
+
+void initHintSearch(HintSearch *hints, Game *game, int timeBudget) {
+    hints->timeBudget = timeBudget;
+    hints->isSolvable = initSolver(&hints->solver, game);
+    if (hints->isSolvable) {
+        initHintStorage(hints);
+        rerootHintSearch(hints, game);
+    }
+}
+
+void rerootHintSearch(HintSearch *hints, Game *game) {
+    if (!hints->isSolvable) {
+        return;
+    }
+
+    SearchState state;
+    getGameSearchState(&hints->solver, game, &state);
+    hints->root = getHintNode(hints, &state);
+}
+
+int getHint(HintSearch *hints, Game *game, PushCommand *hint) {
+    if (!hints->isSolvable) {
+        return 0;
+    }
+    HintNode *root = &hints->nodes[hints->root];
+    if (root->distance == 0 || isDeadHintNode(root)) {
+        return 0;
+    }
+
+    int next = hints->nodes[hints->root].next;
+    if (next == NO_NODE) {
+        next = searchFromRoot(hints);
+    }
+    if (next == NO_NODE) {
+        return 0;
+    }
+
+    int *chestAtCell = malloc(hints->solver.numOfCells * sizeof(int));
+    assert(chestAtCell != NULL);
+    initChestAtCell(&hints->solver, game, chestAtCell);
+    CommandList commands;
+    initCommandList(&commands);
+    addStepCommands(&hints->solver, getTableState(&hints->table, hints->root),
+                    getTableState(&hints->table, next), chestAtCell, &commands);
+
+    *hint = commands.commands[0];
+    int numOfPushes = commands.size;
+
+    disposeCommandList(&commands);
+    free(chestAtCell);
+    return numOfPushes;
+}
+
+void printHint(PushCommand *hint, int numOfPushes) {
+    if (numOfPushes == 0) {
+        printf("-\n");
+    }
+    else {
+        char square = numOfPushes > 1 ? FINAL_BLANK_SQUARE : BLANK_SQUARE;
+        printf("%c%c\n", getChestName(hint->chestNum, square), hint->direction);
+    }
+}
+
+void disposeHintSearch(HintSearch *hints) {
+    if (hints->isSolvable) {
+        disposeHintStorage(hints);
+        disposeSolver(&hints->solver);
+    }
+}
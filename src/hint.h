@@ -0,0 +1,78 @@
+#ifndef HINT_H
+#define HINT_H
+
+#include "solver.h"
+
+#define DEFAULT_HINT_TIME_BUDGET 100
+#define NO_NODE (-1)
+
+/* What the hint search knows about a state of its transposition table. */
+struct HintNode {
+    /* NO_DISTANCE for states known to have no solution. */
+    int heuristic;
+    /* Successors are computed once and kept in the children pool. */
+    int firstChild;
+    int numOfChildren;
+    /* Successor on a known path to solution and number of moves along it. */
+    int next;
+    int distance;
+    /* Data of the current search, valid only if stamps are equal to it. */
+    int cost;
+    int parent;
+    int openStamp;
+    int closedStamp;
+};
+
+typedef struct HintNode HintNode;
+
+struct HeapItem {
+    int priority;
+    int node;
+};
+
+typedef struct HeapItem HeapItem;
+
+/* Anytime best-first search answering hint commands. Transposition table,
+ * expanded nodes and found paths to solution are kept between hints, so
+ * after a push or an undo the search is only re-rooted at the new state.
+ * Hint on a known path is answered without searching at all. Full table is
+ * compacted to nodes reachable from the root rather than cleared.
+ * States stay unpacked in StateTable rather than StateStore, as every
+ * expansion and re-rooting reads them, while the table stays small. */
+struct HintSearch {
+    Solver solver;
+    bool isSolvable;
+    StateTable table;
+    HintNode *nodes;
+    int nodesCapacity;
+    int *children;
+    int childrenSize;
+    int childrenCapacity;
+    HeapItem *heap;
+    int heapSize;
+    int heapCapacity;
+    int stamp;
+    int root;
+    int timeBudget;
+    int numOfSearches;
+};
+
+typedef struct HintSearch HintSearch;
+
+/* Time budget of the first search is given in milliseconds, following
+ * searches get a fraction of it. */
+void initHintSearch(HintSearch *hints, Game *game, int timeBudget);
+
+void rerootHintSearch(HintSearch *hints, Game *game);
+
+/* Computes next push from the current root. Returns number of pushes of the
+ * chest in given direction, more than one for a macro push, or zero if there
+ * is no push leading to solution known. */
+int getHint(HintSearch *hints, Game *game, PushCommand *hint);
+
+/* Prints hint as a command, uppercase for a macro push, or "-" if none. */
+void printHint(PushCommand *hint, int numOfPushes);
+
+void disposeHintSearch(HintSearch *hints);
+
+#endif // HINT_H
@@ -0,0 +1,374 @@
+#include "level_analysis.h"
+#include "command.h"
+#include "squares.h"
+
+static bool isFloorCell(LevelAnalysis *analysis, int row, int col) {
+    return !hasCellFlag(analysis, row, col, WALL_CELL);
+}
+
+static void addCellFlag(LevelAnalysis *analysis, int row, int col, unsigned char flag) {
+    analysis->cells[getCellIndex(analysis, row, col)] |= flag;
+}
+
+static void markWallsAndGoals(LevelAnalysis *analysis, Board *board) {
+    for (int i = 0; i < analysis->numOfRows; i++) {
+        for (int j = 0; j < analysis->numOfCols; j++) {
+            if (j >= board->rows[i]->size || isWallSquare(board->rows[i]->squares[j])) {
+                addCellFlag(analysis, i, j, WALL_CELL);
+            }
+            else if (isFinalSquare(board->rows[i]->squares[j])) {
+                addCellFlag(analysis, i, j, GOAL_CELL);
+            }
+        }
+    }
+}
+
+static void markTunnels(LevelAnalysis *analysis) {
+    for (int i = 0; i < analysis->numOfRows; i++) {
+        for (int j = 0; j < analysis->numOfCols; j++) {
+            if (!isFloorCell(analysis, i, j)) {
+                continue;
+            }
+            if (!isFloorCell(analysis, i - 1, j) && !isFloorCell(analysis, i + 1, j)) {
+                addCellFlag(analysis, i, j, HORIZONTAL_TUNNEL_CELL);
+            }
+            if (!isFloorCell(analysis, i, j - 1) && !isFloorCell(analysis, i, j + 1)) {
+                addCellFlag(analysis, i, j, VERTICAL_TUNNEL_CELL);
+            }
+        }
+    }
+}
+
+#define NO_NUMBER (-1)
+
+/* Depth-first numbering of floor cells. Cells of the subtree of a cell are
+ * numbered consecutively starting with its own number, so an area cut off
+ * from the level by a single cell is one or two ranges of numbers. Low is
+ * the smallest number reachable from the subtree of a cell with a single
+ * edge leaving it. */
+struct FloorNumbering {
+    int *numbers;
+    int *low;
+    int *parents;
+    int *subtreeSizes;
+    int *roots;
+    int *cellsByNumber;
+};
+
+typedef struct FloorNumbering FloorNumbering;
+
+static int *getNewCellArray(int numOfCells) {
+    int *array = malloc(numOfCells * sizeof(int) + 1);
+    assert(array != NULL);
+    return array;
+}
+
+static void initFloorNumbering(FloorNumbering *numbering, int numOfCells) {
+    numbering->numbers = getNewCellArray(numOfCells);
+    numbering->low = getNewCellArray(numOfCells);
+    numbering->parents = getNewCellArray(numOfCells);
+    numbering->subtreeSizes = getNewCellArray(numOfCells);
+    numbering->roots = getNewCellArray(numOfCells);
+    numbering->cellsByNumber = getNewCellArray(numOfCells);
+    for (int i = 0; i < numOfCells; i++) {
+        numbering->numbers[i] = NO_NUMBER;
+    }
+}
+
+static void disposeFloorNumbering(FloorNumbering *numbering) {
+    free(numbering->numbers);
+    free(numbering->low);
+    free(numbering->parents);
+    free(numbering->subtreeSizes);
+    free(numbering->roots);
+    free(numbering->cellsByNumber);
+}
+
+/* Returns floor cell next to given one in given direction (0 to 3),
+ * or NO_NUMBER if there is none. */
+static int getFloorNeighbor(LevelAnalysis *analysis, int cell, int direction) {
+    int row = cell / analysis->numOfCols;
+    int col = cell % analysis->numOfCols;
+    int rowSteps[4] = {-1, 0, 1, 0};
+    int colSteps[4] = {0, 1, 0, -1};
+    row += rowSteps[direction];
+    col += colSteps[direction];
+    return isFloorCell(analysis, row, col) ? getCellIndex(analysis, row, col) : NO_NUMBER;
+}
+
+/* Numbers floor cells of every area of the level with one iterative
+ * depth-first search. */
+static void numberFloorCells(LevelAnalysis *analysis, FloorNumbering *numbering) {
+    int numOfCells = analysis->numOfRows * analysis->numOfCols;
+    int *stack = getNewCellArray(numOfCells);
+    unsigned char *nextDirections = calloc(numOfCells + 1, sizeof(unsigned char));
+    assert(nextDirections != NULL);
+
+    int nextNumber = 0;
+    for (int start = 0; start < numOfCells; start++) {
+        if ((analysis->cells[start] & WALL_CELL) != 0
+            || numbering->numbers[start] != NO_NUMBER) {
+            continue;
+        }
+        numbering->numbers[start] = numbering->low[start] = nextNumber;
+        numbering->cellsByNumber[nextNumber++] = start;
+        numbering->parents[start] = NO_NUMBER;
+        numbering->roots[start] = start;
+        stack[0] = start;
+        int size = 1;
+
+        while (size > 0) {
+            int cell = stack[size - 1];
+            if (nextDirections[cell] < 4) {
+                int neighbor = getFloorNeighbor(analysis, cell, nextDirections[cell]++);
+                if (neighbor == NO_NUMBER || neighbor == numbering->parents[cell]) {
+                    continue;
+                }
+                if (numbering->numbers[neighbor] == NO_NUMBER) {
+                    numbering->numbers[neighbor] = numbering->low[neighbor] = nextNumber;
+                    numbering->cellsByNumber[nextNumber++] = neighbor;
+                    numbering->parents[neighbor] = cell;
+                    numbering->roots[neighbor] = start;
+                    stack[size++] = neighbor;
+                }
+                else if (numbering->numbers[neighbor] < numbering->low[cell]) {
+                    numbering->low[cell] = numbering->numbers[neighbor];
+                }
+                continue;
+            }
+
+            size--;
+            numbering->subtreeSizes[cell] = nextNumber - numbering->numbers[cell];
+            int parent = numbering->parents[cell];
+            if (parent != NO_NUMBER && numbering->low[cell] < numbering->low[parent]) {
+                numbering->low[parent] = numbering->low[cell];
+            }
+        }
+    }
+
+    free(stack);
+    free(nextDirections);
+}
+
+static bool isInSubtree(FloorNumbering *numbering, int cell, int subtreeRoot) {
+    int number = numbering->numbers[cell];
+    int first = numbering->numbers[subtreeRoot];
+    return first <= number && number < first + numbering->subtreeSizes[subtreeRoot];
+}
+
+/* Tells if removing given cell, whose only floor neighbors are the two given
+ * ones, cuts child off from the rest of its area. */
+static bool isCutOffBy(FloorNumbering *numbering, int cell, int child, int other) {
+    return numbering->parents[child] == cell
+           && numbering->low[child] >= numbering->numbers[cell]
+           && !isInSubtree(numbering, other, child);
+}
+
+/* Area of the level given as up to two ranges of cell numbers. */
+struct Room {
+    int firsts[2];
+    int ends[2];
+    int size;
+};
+
+typedef struct Room Room;
+
+/* Finds the area behind entrance, starting from given side, if the entrance
+ * is the only way into it. Returns false if it is not. */
+static bool findAreaBehind(FloorNumbering *numbering, int entrance, int side,
+                           int otherSide, Room *room) {
+    if (isCutOffBy(numbering, entrance, side, otherSide)) {
+        room->firsts[0] = numbering->numbers[side];
+        room->ends[0] = room->firsts[0] + numbering->subtreeSizes[side];
+        room->firsts[1] = room->ends[1] = 0;
+    }
+    else if (isCutOffBy(numbering, entrance, otherSide, side)) {
+        /* Entrance is entered from side, so the other side is its only child
+         * and the rest of the area surrounds the subtree of the entrance. */
+        int root = numbering->roots[entrance];
+        room->firsts[0] = numbering->numbers[root];
+        room->ends[0] = numbering->numbers[entrance];
+        room->firsts[1] = room->ends[0] + numbering->subtreeSizes[entrance];
+        room->ends[1] = room->firsts[0] + numbering->subtreeSizes[root];
+    }
+    else {
+        return false;
+    }
+    room->size = room->ends[0] - room->firsts[0] + room->ends[1] - room->firsts[1];
+    return true;
+}
+
+/* Checks whether the area behind entrance, starting from given side, is
+ * a goal room and adds it to room marks if so, as differences between
+ * marks of consecutive cell numbers. Area is a goal room if the entrance is
+ * the only way into it, it contains storage locations and it is the smaller
+ * part of the level. Side which is a tunnel cell itself is skipped, so that
+ * only the innermost cell of a corridor is considered the entrance. */
+static void markGoalRoomBehind(LevelAnalysis *analysis, FloorNumbering *numbering,
+                               int entrance, int side, int otherSide,
+                               int numOfFloorCells, int *goalCounts, int *roomMarks) {
+    int sideRow = side / analysis->numOfCols;
+    int sideCol = side % analysis->numOfCols;
+    int flags = analysis->cells[entrance] & (HORIZONTAL_TUNNEL_CELL | VERTICAL_TUNNEL_CELL);
+    if (hasCellFlag(analysis, sideRow, sideCol, flags)) {
+        return;
+    }
+
+    Room room;
+    if (!findAreaBehind(numbering, entrance, side, otherSide, &room)
+        || 2 * room.size >= numOfFloorCells) {
+        return;
+    }
+
+    bool hasGoal = false;
+    for (int i = 0; i < 2; i++) {
+        hasGoal = hasGoal || goalCounts[room.ends[i]] > goalCounts[room.firsts[i]];
+    }
+    if (hasGoal) {
+        for (int i = 0; i < 2; i++) {
+            roomMarks[room.firsts[i]]++;
+            roomMarks[room.ends[i]]--;
+        }
+    }
+}
+
+/* Every candidate entrance is checked against a single numbering of floor
+ * cells, so the analysis stays linear in the size of the level. */
+static void markGoalRooms(LevelAnalysis *analysis) {
+    int numOfCells = analysis->numOfRows * analysis->numOfCols;
+    FloorNumbering numbering;
+    initFloorNumbering(&numbering, numOfCells);
+    numberFloorCells(analysis, &numbering);
+
+    int numOfFloorCells = 0;
+    for (int i = 0; i < numOfCells; i++) {
+        if ((analysis->cells[i] & WALL_CELL) == 0) {
+            numOfFloorCells++;
+        }
+    }
+    /* Number of storage locations among cells numbered below given number. */
+    int *goalCounts = malloc((numOfFloorCells + 1) * sizeof(int));
+    assert(goalCounts != NULL);
+    goalCounts[0] = 0;
+    for (int i = 0; i < numOfFloorCells; i++) {
+        int cell = numbering.cellsByNumber[i];
+        goalCounts[i + 1] = goalCounts[i] + ((analysis->cells[cell] & GOAL_CELL) != 0);
+    }
+    int *roomMarks = calloc(numOfFloorCells + 1, sizeof(int));
+    assert(roomMarks != NULL);
+
+    for (int i = 0; i < analysis->numOfRows; i++) {
+        for (int j = 0; j < analysis->numOfCols; j++) {
+            int sides[2];
+            if (hasCellFlag(analysis, i, j, HORIZONTAL_TUNNEL_CELL)
+                && !hasCellFlag(analysis, i, j, VERTICAL_TUNNEL_CELL)) {
+                if (!isFloorCell(analysis, i, j - 1) || !isFloorCell(analysis, i, j + 1)) {
+                    continue;
+                }
+                sides[0] = getCellIndex(analysis, i, j - 1);
+                sides[1] = getCellIndex(analysis, i, j + 1);
+            }
+            else if (hasCellFlag(analysis, i, j, VERTICAL_TUNNEL_CELL)
+                     && !hasCellFlag(analysis, i, j, HORIZONTAL_TUNNEL_CELL)) {
+                if (!isFloorCell(analysis, i - 1, j) || !isFloorCell(analysis, i + 1, j)) {
+                    continue;
+                }
+                sides[0] = getCellIndex(analysis, i - 1, j);
+                sides[1] = getCellIndex(analysis, i + 1, j);
+            }
+            else {
+                continue;
+            }
+
+            int entrance = getCellIndex(analysis, i, j);
+            markGoalRoomBehind(analysis, &numbering, entrance, sides[0], sides[1],
+                               numOfFloorCells, goalCounts, roomMarks);
+            markGoalRoomBehind(analysis, &numbering, entrance, sides[1], sides[0],
+                               numOfFloorCells, goalCounts, roomMarks);
+        }
+    }
+
+    int mark = 0;
+    for (int i = 0; i < numOfFloorCells; i++) {
+        mark += roomMarks[i];
+        if (mark > 0) {
+            analysis->cells[numbering.cellsByNumber[i]] |= GOAL_ROOM_CELL;
+        }
+    }
+
+    free(goalCounts);
+    free(roomMarks);
+    disposeFloorNumbering(&numbering);
+}
+
+void analyzeLevel(LevelAnalysis *analysis, Board *board) {
+    analysis->numOfRows = board->size;
+    analysis->numOfCols = 0;
+    for (int i = 0; i < board->size; i++) {
+        if (board->rows[i]->size > analysis->numOfCols) {
+            analysis->numOfCols = board->rows[i]->size;
+        }
+    }
+    /* Extra column of walls separates rows, so that neighbors of a cell
+     * can be found by adding strides to its index. */
+    analysis->numOfCols++;
+
+    int numOfCells = analysis->numOfRows * analysis->numOfCols;
+    analysis->cells = calloc(numOfCells + 1, sizeof(unsigned char));
+    assert(analysis->cells != NULL);
+
+    markWallsAndGoals(analysis, board);
+    markTunnels(analysis);
+    markGoalRooms(analysis);
+}
+
+/* Computes how many times chest standing at given position is pushed
+ * by a single macro push in given direction. First push is assumed to be
+ * possible. Chest pushed into a tunnel is pushed on until it leaves it,
+ * reaches a storage location or gets blocked. Chest pushed through the
+ * entrance of a goal room is pushed on, as long as it stays in the room,
+ * to the farthest storage location it can reach going straight. */
+int getMacroPushLength(LevelAnalysis *analysis, Position *chestPos, char direction,
+                       IsSquareFreeFunction isSquareFree, void *context) {
+    int row = getPushedChestRowNumber(chestPos->row, direction);
+    int col = getPushedChestColNumber(chestPos->col, direction);
+    int length = 1;
+
+    while (isTunnelCell(analysis, row, col, direction)
+           && !hasCellFlag(analysis, row, col, GOAL_CELL | GOAL_ROOM_CELL)) {
+        int nextRow = getPushedChestRowNumber(row, direction);
+        int nextCol = getPushedChestColNumber(col, direction);
+        if (!isSquareFree(context, nextRow, nextCol)) {
+            break;
+        }
+        row = nextRow;
+        col = nextCol;
+        length++;
+    }
+
+    char backward = getOppositeDirection(direction);
+    int prevRow = getPushedChestRowNumber(row, backward);
+    int prevCol = getPushedChestColNumber(col, backward);
+    if (hasCellFlag(analysis, row, col, GOAL_ROOM_CELL)
+        && !hasCellFlag(analysis, prevRow, prevCol, GOAL_ROOM_CELL)) {
+        int scanLength = length;
+        int goalLength = length;
+        while (true) {
+            int nextRow = getPushedChestRowNumber(row, direction);
+            int nextCol = getPushedChestColNumber(col, direction);
+            if (!hasCellFlag(analysis, nextRow, nextCol, GOAL_ROOM_CELL)
+                || !isSquareFree(context, nextRow, nextCol)) {
+                break;
+            }
+            row = nextRow;
+            col = nextCol;
+            scanLength++;
+            if (hasCellFlag(analysis, row, col, GOAL_CELL)) {
+                goalLength = scanLength;
+            }
+        }
+        length = goalLength;
+    }
+
+    return length;
+}
@@ -0,0 +1,70 @@
+#ifndef LEVEL_ANALYSIS_H
+#define LEVEL_ANALYSIS_H
+
+#include <stdbool.h>
+
+#include "board.h"
+#include "move.h"
+
+/* Flags describing static properties of a cell of the level. Walls and storage
+ * locations never change during the game, so the analysis is done once. */
+#define WALL_CELL 1
+#define GOAL_CELL 2
+/* Cell with walls above and below, box pushed left or right through it
+ * can only go on in the same direction. */
+#define HORIZONTAL_TUNNEL_CELL 4
+/* Cell with walls on the left and on the right. */
+#define VERTICAL_TUNNEL_CELL 8
+/* Cell of a room with storage locations which can only be entered through
+ * a single one cell wide entrance. */
+#define GOAL_ROOM_CELL 16
+
+/* Board is not rectangular in general, cells beyond the end of a row
+ * are treated as walls. */
+struct LevelAnalysis {
+    int numOfRows;
+    int numOfCols;
+    unsigned char *cells;
+};
+
+typedef struct LevelAnalysis LevelAnalysis;
+
+/* Tells if square at given position can currently be entered by a chest. */
+typedef bool (*IsSquareFreeFunction)(void *context, int row, int col);
+
+void analyzeLevel(LevelAnalysis *analysis, Board *board);
+
+int getMacroPushLength(LevelAnalysis *analysis, Position *chestPos, char direction,
+                       IsSquareFreeFunction isSquareFree, void *context);
+
+static inline int getCellIndex(LevelAnalysis *analysis, int row, int col) {
+    return row * analysis->numOfCols + col;
+}
+
+static inline bool isCellInRange(LevelAnalysis *analysis, int row, int col) {
+    return 0 <= row && row < analysis->numOfRows && 0 <= col && col < analysis->numOfCols;
+}
+
+static inline bool hasCellFlag(LevelAnalysis *analysis, int row, int col,
+                               unsigned char flag) {
+    if (!isCellInRange(analysis, row, col)) {
+        return flag == WALL_CELL;
+    }
+    return (analysis->cells[getCellIndex(analysis, row, col)] & flag) != 0;
+}
+
+static inline bool isTunnelCell(LevelAnalysis *analysis, int row, int col,
+                                char direction) {
+    if (direction == LEFT || direction == RIGHT) {
+        return hasCellFlag(analysis, row, col, HORIZONTAL_TUNNEL_CELL);
+    }
+    else {
+        return hasCellFlag(analysis, row, col, VERTICAL_TUNNEL_CELL);
+    }
+}
+
+static inline void disposeLevelAnalysis(LevelAnalysis *analysis) {
+    free(analysis->cells);
+}
+
+#endif // LEVEL_ANALYSIS_H
@@ -9,17 +9,39 @@
 #define LEFT '4'
 #define RIGHT '6'
 
+/* Single undo entry. Chest is pushed numOfPushes times in the same
+ * direction, more than once only by a macro push. */
 struct Move {
     int chestNum;
+    char direction;
+    int numOfPushes;
     Position *prevPlayerPos;
 };
 
 typedef struct Move Move;
 
-static inline Move *getNewMove(int chestNum, Position *prevPlayerPos) {
+static inline char getOppositeDirection(char direction) {
+    if (direction == DOWN) {
+        return UP;
+    }
+    else if (direction == UP) {
+        return DOWN;
+    }
+    else if (direction == LEFT) {
+        return RIGHT;
+    }
+    else {
+        return LEFT;
+    }
+}
+
+static inline Move *getNewMove(int chestNum, char direction, int numOfPushes,
+                               Position *prevPlayerPos) {
     Move *move = malloc(sizeof(Move));
     assert(move != NULL);
     move->chestNum = chestNum;
+    move->direction = direction;
+    move->numOfPushes = numOfPushes;
     move->prevPlayerPos = prevPlayerPos;
     return move;
 }
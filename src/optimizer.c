@@ -0,0 +1,340 @@
+#include "optimizer.h"
+#include "state_store.h"
+#include "thread_pool.h"
+
+#define NO_SHORTCUT (-1)
+
+/* Best shortcut found in a window: states leading from its first state
+ * to state of the path at given end, the last of them being that state. */
+struct WindowShortcut {
+    int end;
+    int saving;
+    SearchState *states;
+    int numOfStates;
+};
+
+typedef struct WindowShortcut WindowShortcut;
+
+struct OptimizerWorker {
+    Solver solver;
+    int *pushes;
+};
+
+typedef struct OptimizerWorker OptimizerWorker;
+
+/* Data shared by windows searched in a single round, read only
+ * except for the shortcut of each window and scratch of each worker. */
+struct OptimizerRound {
+    OptimizerPath *path;
+    StateStore pathIndex;
+    int *prefixPushes;
+    int windowDepth;
+    OptimizerWorker *workers;
+    WindowShortcut *shortcuts;
+};
+
+typedef struct OptimizerRound OptimizerRound;
+
+void initOptimizerPath(OptimizerPath *path, Game *game) {
+    path->game = game;
+    path->isOptimizable = initSolver(&path->solver, game);
+    if (!path->isOptimizable) {
+        return;
+    }
+
+    path->size = 0;
+    path->capacity = INITIAL_CAPACITY;
+    path->states = malloc(path->capacity * sizeof(SearchState));
+    assert(path->states != NULL);
+    path->chestAtCell = malloc(path->solver.numOfCells * sizeof(int));
+    assert(path->chestAtCell != NULL);
+    initChestAtCell(&path->solver, game, path->chestAtCell);
+    initStatePacker(&path->packer, &path->solver);
+    path->playerCell = getCellIndex(path->solver.analysis, game->playerPos->row,
+                                    game->playerPos->col);
+    addGameToOptimizerPath(path);
+}
+
+void addGameToOptimizerPath(OptimizerPath *path) {
+    if (!path->isOptimizable) {
+        return;
+    }
+    if (path->size == path->capacity) {
+        path->capacity *= GROWTH_FACTOR;
+        path->states = realloc(path->states, path->capacity * sizeof(SearchState));
+        assert(path->states != NULL);
+    }
+    getGameSearchState(&path->solver, path->game, &path->states[path->size]);
+    path->size++;
+}
+
+void removeLastFromOptimizerPath(OptimizerPath *path) {
+    if (path->isOptimizable && path->size > 1) {
+        path->size--;
+    }
+}
+
+int getOptimizerPathNumOfPushes(OptimizerPath *path) {
+    int numOfPushes = 0;
+    for (int i = 0; i + 1 < path->size; i++) {
+        numOfPushes += getStepNumOfPushes(&path->solver, &path->states[i],
+                                          &path->states[i + 1]);
+    }
+    return numOfPushes;
+}
+
+int getOptimizerPathNumOfMoves(OptimizerPath *path) {
+    int numOfMoves = 0;
+    int playerCell = path->playerCell;
+    for (int i = 0; i + 1 < path->size; i++) {
+        numOfMoves += getStepNumOfMoves(&path->solver, &path->states[i],
+                                        &path->states[i + 1], &playerCell);
+    }
+    return numOfMoves;
+}
+
+/* Cuts out parts of the path between visits of the same state, so that
+ * every state occurs in it once. */
+static void removeLoops(OptimizerPath *path) {
+    StateStore table;
+    initStateStore(&table, &path->packer, path->solver.numOfChests);
+    /* Position of state of the table in the path being built, -1 if it was
+     * cut out, and state of the table at each position. */
+    int *positions = malloc(path->size * sizeof(int));
+    assert(positions != NULL);
+    int *entries = malloc(path->size * sizeof(int));
+    assert(entries != NULL);
+
+    int size = 0;
+    for (int i = 0; i < path->size; i++) {
+        SearchState state = path->states[i];
+        int entry = findStoredState(&table, &state);
+        if (entry != NO_STORED_STATE && positions[entry] != -1) {
+            while (size > positions[entry] + 1) {
+                size--;
+                positions[entries[size]] = -1;
+            }
+            continue;
+        }
+
+        if (entry == NO_STORED_STATE) {
+            entry = addStoredState(&table, &state, NO_PARENT);
+        }
+        positions[entry] = size;
+        entries[size] = entry;
+        path->states[size] = state;
+        size++;
+    }
+    path->size = size;
+
+    free(entries);
+    free(positions);
+    disposeStateStore(&table);
+}
+
+/* Runs breadth-first search from state of the path at given position
+ * and remembers the shortcut saving the most pushes. */
+static void searchWindow(void *context, int worker, int start) {
+    OptimizerRound *round = context;
+    OptimizerPath *path = round->path;
+    Solver *solver = &round->workers[worker].solver;
+    int *pushes = round->workers[worker].pushes;
+    WindowShortcut *shortcut = &round->shortcuts[start];
+    shortcut->end = NO_SHORTCUT;
+    shortcut->saving = 0;
+    shortcut->states = NULL;
+    shortcut->numOfStates = 0;
+
+    StateStore table;
+    initStateStore(&table, &path->packer, solver->numOfChests);
+    addStoredState(&table, &path->states[start], NO_PARENT);
+    pushes[0] = 0;
+
+    SearchState successors[MAX_NUM_OF_SUCCESSORS];
+    unsigned char key[MAX_PACKED_KEY_SIZE];
+    int best = NO_PARENT;
+    int layerStart = 0;
+    bool isFull = false;
+    for (int depth = 0; depth < round->windowDepth && !isFull; depth++) {
+        int layerEnd = table.size;
+        for (int i = layerStart; i < layerEnd && !isFull; i++) {
+            SearchState state;
+            getStoredState(&table, i, &state);
+            int size = expandPushes(solver, &state, successors);
+            for (int j = 0; j < size; j++) {
+                packStateKey(&table, &successors[j], key);
+                uint64_t hash = hashStateKey(&table, key);
+                if (findStateKey(&table, key, hash) != NO_STORED_STATE) {
+                    continue;
+                }
+                if (table.size == MAX_NUM_OF_WINDOW_STATES) {
+                    isFull = true;
+                    break;
+                }
+
+                int index = addStateKey(&table, key, hash, i);
+                pushes[index] = pushes[i] + getStepNumOfPushes(solver, &state,
+                                                               &successors[j]);
+                int end = findStateKey(&round->pathIndex, key, hash);
+                if (end > start) {
+                    int saving = round->prefixPushes[end] - round->prefixPushes[start]
+                                 - pushes[index];
+                    if (saving > shortcut->saving) {
+                        shortcut->end = end;
+                        shortcut->saving = saving;
+                        best = index;
+                    }
+                }
+            }
+        }
+        layerStart = layerEnd;
+    }
+
+    if (best != NO_PARENT) {
+        for (int i = best; getStoredParent(&table, i) != NO_PARENT;
+             i = getStoredParent(&table, i)) {
+            shortcut->numOfStates++;
+        }
+        shortcut->states = malloc(shortcut->numOfStates * sizeof(SearchState));
+        assert(shortcut->states != NULL);
+        int position = shortcut->numOfStates;
+        for (int i = best; getStoredParent(&table, i) != NO_PARENT;
+             i = getStoredParent(&table, i)) {
+            position--;
+            getStoredState(&table, i, &shortcut->states[position]);
+        }
+    }
+
+    disposeStateStore(&table);
+}
+
+/* Replaces parts of the path with shortcuts, from its beginning, skipping
+ * shortcuts starting in already replaced parts. Returns false if there
+ * were no shortcuts. */
+static bool applyShortcuts(OptimizerPath *path, WindowShortcut shortcuts[]) {
+    bool isChanged = false;
+    int capacity = path->size;
+    for (int i = 0; i < path->size; i++) {
+        capacity += shortcuts[i].numOfStates;
+    }
+    SearchState *states = malloc(capacity * sizeof(SearchState));
+    assert(states != NULL);
+
+    int size = 0;
+    int i = 0;
+    while (i < path->size) {
+        states[size] = path->states[i];
+        size++;
+        if (shortcuts[i].end != NO_SHORTCUT) {
+            /* Last state of the shortcut is added as the state at its end. */
+            for (int j = 0; j + 1 < shortcuts[i].numOfStates; j++) {
+                states[size] = shortcuts[i].states[j];
+                size++;
+            }
+            i = shortcuts[i].end;
+            isChanged = true;
+        }
+        else {
+            i++;
+        }
+    }
+
+    free(path->states);
+    path->states = states;
+    path->size = size;
+    path->capacity = capacity;
+    return isChanged;
+}
+
+/* Searches windows of all states of the path but the last one in parallel
+ * and applies found shortcuts. Returns false if there were none. */
+static bool runOptimizerRound(OptimizerPath *path, OptimizerWorker workers[],
+                              int numOfThreads, int windowDepth) {
+    OptimizerRound round;
+    round.path = path;
+    round.windowDepth = windowDepth;
+    round.workers = workers;
+
+    /* States of the path are distinct, so index of each is its position. */
+    initStateStore(&round.pathIndex, &path->packer, path->solver.numOfChests);
+    round.prefixPushes = malloc(path->size * sizeof(int));
+    assert(round.prefixPushes != NULL);
+    for (int i = 0; i < path->size; i++) {
+        addStoredState(&round.pathIndex, &path->states[i], NO_PARENT);
+        round.prefixPushes[i] = i == 0 ? 0 : round.prefixPushes[i - 1]
+                                             + getStepNumOfPushes(&path->solver,
+                                                                  &path->states[i - 1],
+                                                                  &path->states[i]);
+    }
+
+    int numOfWindows = path->size - 1;
+    round.shortcuts = malloc(path->size * sizeof(WindowShortcut));
+    assert(round.shortcuts != NULL);
+    round.shortcuts[numOfWindows].end = NO_SHORTCUT;
+    round.shortcuts[numOfWindows].states = NULL;
+    round.shortcuts[numOfWindows].numOfStates = 0;
+    runTasksInPool(numOfThreads, numOfWindows, searchWindow, &round);
+
+    bool isChanged = applyShortcuts(path, round.shortcuts);
+
+    for (int i = 0; i < numOfWindows; i++) {
+        free(round.shortcuts[i].states);
+    }
+    free(round.shortcuts);
+    free(round.prefixPushes);
+    disposeStateStore(&round.pathIndex);
+    return isChanged;
+}
+
+void optimizePath(OptimizerPath *path, int windowDepth, int numOfThreads) {
+    if (!path->isOptimizable) {
+        return;
+    }
+    if (numOfThreads > MAX_NUM_OF_POOL_THREADS) {
+        numOfThreads = MAX_NUM_OF_POOL_THREADS;
+    }
+
+    OptimizerWorker workers[MAX_NUM_OF_POOL_THREADS];
+    for (int i = 0; i < numOfThreads; i++) {
+        /* Level is searchable, as the path is optimizable. */
+        initSolver(&workers[i].solver, path->game);
+        workers[i].pushes = malloc(MAX_NUM_OF_WINDOW_STATES * sizeof(int));
+        assert(workers[i].pushes != NULL);
+    }
+
+    bool isChanged = true;
+    while (isChanged) {
+        removeLoops(path);
+        isChanged = path->size > 1
+                    && runOptimizerRound(path, workers, numOfThreads, windowDepth);
+    }
+
+    for (int i = 0; i < numOfThreads; i++) {
+        free(workers[i].pushes);
+        disposeSolver(&workers[i].solver);
+    }
+}
+
+void addOptimizerPathCommands(OptimizerPath *path, CommandList *commands) {
+    if (!path->isOptimizable) {
+        return;
+    }
+
+    int *chestAtCell = malloc(path->solver.numOfCells * sizeof(int));
+    assert(chestAtCell != NULL);
+    memcpy(chestAtCell, path->chestAtCell, path->solver.numOfCells * sizeof(int));
+    for (int i = 0; i + 1 < path->size; i++) {
+        addStepCommands(&path->solver, &path->states[i], &path->states[i + 1],
+                        chestAtCell, commands);
+    }
+    free(chestAtCell);
+}
+
+void disposeOptimizerPath(OptimizerPath *path) {
+    if (path->isOptimizable) {
+        free(path->states);
+        free(path->chestAtCell);
+        disposeStatePacker(&path->packer);
+        disposeSolver(&path->solver);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "packed_state.h"
+
+#define DEFAULT_OPTIMIZER_WINDOW 8
+#define MAX_NUM_OF_WINDOW_STATES 50000
+
+/* Sequence of states visited by an accepted solution, from the initial one,
+ * one state per push or macro push. Names of chests and position of player
+ * are taken from the game at the time the path is started. */
+struct OptimizerPath {
+    Game *game;
+    Solver solver;
+    StatePacker packer;
+    bool isOptimizable;
+    SearchState *states;
+    int size;
+    int capacity;
+    int *chestAtCell;
+    int playerCell;
+};
+
+typedef struct OptimizerPath OptimizerPath;
+
+/* Starts path at the current state of the game. Path is not optimizable
+ * if the level is too large to be searched. */
+void initOptimizerPath(OptimizerPath *path, Game *game);
+
+/* Adds current state of the game, which has to be reached from the last
+ * state of the path with a push or a macro push. */
+void addGameToOptimizerPath(OptimizerPath *path);
+
+/* Removes last state, reverting the push which lead to it. */
+void removeLastFromOptimizerPath(OptimizerPath *path);
+
+int getOptimizerPathNumOfPushes(OptimizerPath *path);
+
+int getOptimizerPathNumOfMoves(OptimizerPath *path);
+
+/* Shortens path, keeping its first and last state, so that it takes fewer
+ * pushes. Loops are cut out first, then each state starts a window in which
+ * breadth-first search of given depth, in pushes and macro pushes, looks
+ * for shortcuts to later states of the path. Windows are searched
+ * in parallel, non-overlapping shortcuts are taken and it is repeated
+ * until no shortcut is found. */
+void optimizePath(OptimizerPath *path, int windowDepth, int numOfThreads);
+
+/* Appends push commands along the path. */
+void addOptimizerPathCommands(OptimizerPath *path, CommandList *commands);
+
+void disposeOptimizerPath(OptimizerPath *path);
+
+#endif // OPTIMIZER_H
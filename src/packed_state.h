@@ -0,0 +1,80 @@
+#ifndef PACKED_STATE_H
+#define PACKED_STATE_H
+
+#include <string.h>
+
+#include "solver.h"
+
+#define BITS_IN_BYTE 8
+#define PACKED_PLAYER_SIZE 2
+#define MAX_PACKED_KEY_SIZE \
+    (PACKED_PLAYER_SIZE + (MAX_NUM_OF_SEARCH_CELLS + BITS_IN_BYTE - 1) / BITS_IN_BYTE)
+
+/* Packs search states into keys of fixed size: number of the player's floor
+ * cell in big endian order, followed by set of floor cells with chests, one
+ * bit per cell. Floor cells are numbered in order of cells, so keys compared
+ * with memcmp are ordered by player first and chests are unpacked sorted. */
+struct StatePacker {
+    int numOfCells;
+    int numOfFloorCells;
+    int *floorNums;
+    int16_t *floorCells;
+    int keySize;
+};
+
+typedef struct StatePacker StatePacker;
+
+static inline void initStatePacker(StatePacker *packer, Solver *solver) {
+    packer->numOfCells = solver->numOfCells;
+    packer->floorNums = malloc(solver->numOfCells * sizeof(int));
+    assert(packer->floorNums != NULL);
+    packer->floorCells = malloc(solver->numOfCells * sizeof(int16_t));
+    assert(packer->floorCells != NULL);
+
+    packer->numOfFloorCells = 0;
+    for (int i = 0; i < solver->numOfCells; i++) {
+        if (isFloorSearchCell(solver, i)) {
+            packer->floorNums[i] = packer->numOfFloorCells;
+            packer->floorCells[packer->numOfFloorCells] = (int16_t) i;
+            packer->numOfFloorCells++;
+        }
+        else {
+            packer->floorNums[i] = NO_CELL;
+        }
+    }
+    packer->keySize = PACKED_PLAYER_SIZE
+                      + (packer->numOfFloorCells + BITS_IN_BYTE - 1) / BITS_IN_BYTE;
+}
+
+static inline void packSearchState(StatePacker *packer, SearchState *state,
+                                   int numOfChests, unsigned char *key) {
+    memset(key, 0, packer->keySize);
+    int player = packer->floorNums[state->player];
+    key[0] = (unsigned char) (player >> BITS_IN_BYTE);
+    key[1] = (unsigned char) player;
+    for (int i = 0; i < numOfChests; i++) {
+        int chest = packer->floorNums[state->chests[i]];
+        key[PACKED_PLAYER_SIZE + chest / BITS_IN_BYTE] |= 1 << (chest % BITS_IN_BYTE);
+    }
+}
+
+static inline void unpackSearchState(StatePacker *packer, const unsigned char *key,
+                                     SearchState *state) {
+    initSearchState(state);
+    state->player = packer->floorCells[(key[0] << BITS_IN_BYTE) | key[1]];
+    int numOfChests = 0;
+    for (int i = PACKED_PLAYER_SIZE; i < packer->keySize; i++) {
+        for (int bits = key[i]; bits != 0; bits &= bits - 1) {
+            int chest = (i - PACKED_PLAYER_SIZE) * BITS_IN_BYTE + __builtin_ctz(bits);
+            state->chests[numOfChests] = packer->floorCells[chest];
+            numOfChests++;
+        }
+    }
+}
+
+static inline void disposeStatePacker(StatePacker *packer) {
+    free(packer->floorNums);
+    free(packer->floorCells);
+}
+
+#endif // PACKED_STATE_H
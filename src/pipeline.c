@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "pipeline.h"
+#include "spsc_ring.h"
+
+struct ReaderStage {
+    SpscRing *commands;
+};
+
+typedef struct ReaderStage ReaderStage;
+
+struct RendererStage {
+    SpscRing *diffs;
+    Board board;
+};
+
+typedef struct RendererStage RendererStage;
+
+static void *runReaderStage(void *arg) {
+    ReaderStage *reader = arg;
+    StageCommand command;
+
+    int c = getchar();
+    while (c != END_OF_DATA && c != EOF) {
+        if (c == UNDO_COMMAND) {
+            command.type = UNDO_STAGE_COMMAND;
+        }
+        else if (c == HINT_COMMAND) {
+            command.type = HINT_STAGE_COMMAND;
+        }
+        else {
+            command.type = isMacroPushCommand(c) ? MACRO_PUSH_STAGE_COMMAND
+                                                 : PUSH_STAGE_COMMAND;
+            command.pushComm.chestNum = getChestNum(c);
+            command.pushComm.direction = getchar();
+        }
+        pushToRing(reader->commands, &command);
+        getchar();
+        c = getchar();
+    }
+
+    command.type = END_STAGE_COMMAND;
+    pushToRing(reader->commands, &command);
+    return NULL;
+}
+
+static void *runRendererStage(void *arg) {
+    RendererStage *renderer = arg;
+    StageDiff stageDiff;
+
+    popFromRing(renderer->diffs, &stageDiff);
+    while (!stageDiff.isEnd) {
+        if (stageDiff.isHint) {
+            printHint(&stageDiff.hint, stageDiff.numOfHintPushes);
+        }
+        else {
+            BoardDiff *diff = &stageDiff.diff;
+            for (int i = 0; i < diff->size; i++) {
+                Position *pos = &diff->changes[i].pos;
+                renderer->board.rows[pos->row]->squares[pos->col] = diff->changes[i].square;
+            }
+            printBoard(&renderer->board);
+        }
+        popFromRing(renderer->diffs, &stageDiff);
+    }
+    return NULL;
+}
+
+/* Stages cannot be replaced by anything, so game ends if one
+ * cannot be started. */
+static void startStage(pthread_t *thread, void *(*runStage)(void *), void *stage) {
+    int result = pthread_create(thread, NULL, runStage, stage);
+    if (result != 0) {
+        fprintf(stderr, "pthread_create: %s\n", strerror(result));
+        exit(1);
+    }
+}
+
+void readAndExecuteCommandsPipelined(Game *game, int hintTimeBudget) {
+    MoveStack stack;
+    initMoveStack(&stack);
+    HintSearch hints;
+    bool areHintsStarted = false;
+
+    SpscRing commands;
+    initSpscRing(&commands, PIPELINE_RING_CAPACITY, sizeof(StageCommand));
+    SpscRing diffs;
+    initSpscRing(&diffs, PIPELINE_RING_CAPACITY, sizeof(StageDiff));
+
+    ReaderStage reader;
+    reader.commands = &commands;
+    RendererStage renderer;
+    renderer.diffs = &diffs;
+    copyBoard(&renderer.board, game->board);
+
+    pthread_t readerThread;
+    pthread_t rendererThread;
+    startStage(&readerThread, runReaderStage, &reader);
+    startStage(&rendererThread, runRendererStage, &renderer);
+
+    StageCommand command;
+    StageDiff stageDiff;
+    stageDiff.isEnd = false;
+    popFromRing(&commands, &command);
+    while (command.type != END_STAGE_COMMAND) {
+        initBoardDiff(&stageDiff.diff);
+        stageDiff.isHint = command.type == HINT_STAGE_COMMAND;
+        if (stageDiff.isHint) {
+            if (!areHintsStarted) {
+                initHintSearch(&hints, game, hintTimeBudget);
+                areHintsStarted = true;
+            }
+            stageDiff.numOfHintPushes = getHint(&hints, game, &stageDiff.hint);
+        }
+        else if (command.type == UNDO_STAGE_COMMAND) {
+            if (!isMoveStackEmpty(&stack)) {
+                watchUndoCommandSquares(&stageDiff.diff, game, &stack);
+                executeUndoCommand(game, &stack);
+            }
+        }
+        else if (isPushCommandPossible(game, &command.pushComm)) {
+            int numOfPushes = 1;
+            if (command.type == MACRO_PUSH_STAGE_COMMAND) {
+                numOfPushes = getMacroPushCommandLength(game, &command.pushComm);
+            }
+            watchPushCommandSquares(&stageDiff.diff, game, &command.pushComm, numOfPushes);
+            executeMultiplePushCommand(game, &command.pushComm, numOfPushes, &stack);
+        }
+        if (areHintsStarted && !stageDiff.isHint) {
+            rerootHintSearch(&hints, game);
+        }
+        collectBoardDiff(&stageDiff.diff, game);
+        pushToRing(&diffs, &stageDiff);
+        popFromRing(&commands, &command);
+    }
+
+    stageDiff.isEnd = true;
+    pushToRing(&diffs, &stageDiff);
+
+    pthread_join(readerThread, NULL);
+    pthread_join(rendererThread, NULL);
+
+    if (areHintsStarted) {
+        disposeHintSearch(&hints);
+    }
+    disposeBoard(&renderer.board);
+    disposeSpscRing(&commands);
+    disposeSpscRing(&diffs);
+    clearMoveStack(&stack);
+}
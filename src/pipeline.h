@@ -0,0 +1,42 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "game.h"
+#include "board_diff.h"
+#include "hint.h"
+
+#define PIPELINE_RING_CAPACITY 4096
+
+#define PUSH_STAGE_COMMAND 'p'
+#define MACRO_PUSH_STAGE_COMMAND 'm'
+#define UNDO_STAGE_COMMAND 'u'
+#define HINT_STAGE_COMMAND 'h'
+#define END_STAGE_COMMAND 'e'
+
+/* Command decoded by the reader stage and passed to the engine stage. */
+struct StageCommand {
+    char type;
+    PushCommand pushComm;
+};
+
+typedef struct StageCommand StageCommand;
+
+/* Result of a single command passed from the engine stage to the renderer
+ * stage. Renderer keeps its own copy of the board and applies the diff
+ * to it, so that it never reads the board the engine is modifying. */
+struct StageDiff {
+    bool isEnd;
+    bool isHint;
+    PushCommand hint;
+    int numOfHintPushes;
+    BoardDiff diff;
+};
+
+typedef struct StageDiff StageDiff;
+
+/* Does the same as the interactive loop, but reading and decoding commands,
+ * executing them and printing the board run on three threads connected with
+ * single-producer single-consumer rings. Output is identical. */
+void readAndExecuteCommandsPipelined(Game *game, int hintTimeBudget);
+
+#endif // PIPELINE_H
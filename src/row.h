@@ -51,12 +51,16 @@ static inline void loadLineToRow(Row *row, int c) {
     } while (c != '\n');
 }
 
-static inline void printRow(Row *row) {
-    for (int i = 0; i < row->size; i++) {
-        printf("%c", row->squares[i]);
+static inline void loadSquaresToRow(Row *row, const char *squares, int size) {
+    for (int i = 0; i < size; i++) {
+        addToRow(row, squares[i]);
     }
 }
 
+static inline void printRow(Row *row) {
+    fwrite(row->squares, sizeof(char), row->size, stdout);
+}
+
 static inline void disposeRow(Row *row) {
     free(row->squares);
 }
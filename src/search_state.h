@@ -0,0 +1,65 @@
+#ifndef SEARCH_STATE_H
+#define SEARCH_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "position.h"
+
+#define NO_CELL (-1)
+#define MAX_NUM_OF_SEARCH_CELLS 32767
+
+/* State of the game as seen by searches. Chests are indistinguishable, their
+ * cells are kept sorted and unused entries are set to NO_CELL. Player can
+ * walk freely without pushing, so only the area it can reach matters and it
+ * is represented by its smallest cell. Cells are indices of level analysis. */
+struct SearchState {
+    int16_t chests[NUM_OF_CHESTS];
+    int16_t player;
+};
+
+typedef struct SearchState SearchState;
+
+static inline void initSearchState(SearchState *state) {
+    for (int i = 0; i < NUM_OF_CHESTS; i++) {
+        state->chests[i] = NO_CELL;
+    }
+    state->player = NO_CELL;
+}
+
+/* Moves chest at given index to new cell and restores order of chests. */
+static inline void moveSearchStateChest(SearchState *state, int numOfChests,
+                                      int index, int cell) {
+    while (index > 0 && state->chests[index - 1] > cell) {
+        state->chests[index] = state->chests[index - 1];
+        index--;
+    }
+    while (index < numOfChests - 1 && state->chests[index + 1] < cell) {
+        state->chests[index] = state->chests[index + 1];
+        index++;
+    }
+    state->chests[index] = (int16_t) cell;
+}
+
+static inline void sortSearchStateChests(SearchState *state, int numOfChests) {
+    for (int i = 1; i < numOfChests; i++) {
+        moveSearchStateChest(state, i + 1, i, state->chests[i]);
+    }
+}
+
+static inline bool areSearchStatesEqual(SearchState *state1, SearchState *state2) {
+    return memcmp(state1, state2, sizeof(SearchState)) == 0;
+}
+
+/* FNV-1a over used part of the state. */
+static inline uint64_t hashSearchState(SearchState *state, int numOfChests) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < numOfChests; i++) {
+        hash = (hash ^ (uint16_t) state->chests[i]) * 1099511628211ULL;
+    }
+    hash = (hash ^ (uint16_t) state->player) * 1099511628211ULL;
+    return hash ^ (hash >> 29);
+}
+
+#endif // SEARCH_STATE_H
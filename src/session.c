@@ -0,0 +1,147 @@
+#include <stdio.h>
+
+#include "session.h"
+
+void initSession(Session *session) {
+    initBoard(&session->board);
+    initMoveStack(&session->stack);
+    session->isGameStarted = false;
+    session->isClosed = false;
+    initTextBuffer(&session->input);
+    initTextBuffer(&session->output);
+}
+
+static void writeBoard(Session *session) {
+    Board *board = &session->board;
+    for (int i = 0; i < board->size; i++) {
+        appendToTextBuffer(&session->output, board->rows[i]->squares,
+                           board->rows[i]->size);
+        addToTextBuffer(&session->output, '\n');
+    }
+    addToTextBuffer(&session->output, '\n');
+}
+
+static void writeBoardDiff(Session *session, BoardDiff *diff) {
+    char change[64];
+    for (int i = 0; i < diff->size; i++) {
+        int length = snprintf(change, sizeof(change), "%s%d %d %c",
+                              i == 0 ? "" : " ",
+                              diff->changes[i].pos.row, diff->changes[i].pos.col,
+                              diff->changes[i].square);
+        appendToTextBuffer(&session->output, change, length);
+    }
+    addToTextBuffer(&session->output, '\n');
+}
+
+static void startGame(Session *session) {
+    session->playerPos.row = -1;
+    session->playerPos.col = -1;
+    initGame(&session->game, &session->board, &session->playerPos);
+    session->isGameStarted = true;
+
+    if (session->playerPos.row < 0) {
+        /* There is no player on the board, game cannot be played. */
+        session->isClosed = true;
+    }
+    else {
+        writeBoard(session);
+    }
+}
+
+/* Executes command given in line and writes squares changed by it.
+ * Malformed commands and commands naming missing chests change nothing. */
+static void executeSessionCommand(Session *session, const char *line, int size) {
+    BoardDiff diff;
+    initBoardDiff(&diff);
+
+    if (size == 1 && line[0] == UNDO_COMMAND) {
+        if (!isMoveStackEmpty(&session->stack)) {
+            watchUndoCommandSquares(&diff, &session->game, &session->stack);
+            executeUndoCommand(&session->game, &session->stack);
+        }
+    }
+    else if (size == 2 && isChestSquare(line[0]) && isDirectionCommand(line[1])) {
+        PushCommand pushComm;
+        pushComm.chestNum = getChestNum(line[0]);
+        pushComm.direction = line[1];
+        if (getChestPosition(&session->game, pushComm.chestNum) != NULL &&
+            isPushCommandPossible(&session->game, &pushComm)) {
+            int numOfPushes = 1;
+            if (isMacroPushCommand(line[0])) {
+                numOfPushes = getMacroPushCommandLength(&session->game, &pushComm);
+            }
+            watchPushCommandSquares(&diff, &session->game, &pushComm, numOfPushes);
+            executeMultiplePushCommand(&session->game, &pushComm, numOfPushes,
+                                       &session->stack);
+        }
+    }
+
+    collectBoardDiff(&diff, &session->game);
+    writeBoardDiff(session, &diff);
+}
+
+static void processLine(Session *session, const char *line, int size) {
+    if (size > 0 && line[size - 1] == '\r') {
+        size--;
+    }
+
+    if (!session->isGameStarted) {
+        if (size == 0) {
+            startGame(session);
+        }
+        else if (session->board.size == MAX_SESSION_BOARD_SIZE) {
+            session->isClosed = true;
+        }
+        else {
+            Row *row = getNewRow();
+            loadSquaresToRow(row, line, size);
+            addToBoard(&session->board, row);
+        }
+    }
+    else if (size == 1 && line[0] == END_OF_DATA) {
+        session->isClosed = true;
+    }
+    else {
+        executeSessionCommand(session, line, size);
+    }
+}
+
+void feedSession(Session *session, const char *data, int size) {
+    appendToTextBuffer(&session->input, data, size);
+
+    int lineStart = 0;
+    for (int i = 0; i < session->input.size && !session->isClosed; i++) {
+        if (session->input.text[i] == '\n') {
+            if (i - lineStart > MAX_SESSION_LINE_SIZE) {
+                session->isClosed = true;
+            }
+            else {
+                processLine(session, session->input.text + lineStart, i - lineStart);
+            }
+            lineStart = i + 1;
+        }
+    }
+    if (session->input.size - lineStart > MAX_SESSION_LINE_SIZE) {
+        /* Rest of the line is not waited for. */
+        session->isClosed = true;
+    }
+
+    if (session->isClosed) {
+        session->input.size = 0;
+    }
+    else {
+        consumeTextBuffer(&session->input, lineStart);
+    }
+}
+
+void disposeSession(Session *session) {
+    clearMoveStack(&session->stack);
+    if (session->isGameStarted) {
+        disposeGame(&session->game);
+    }
+    else {
+        disposeBoard(&session->board);
+    }
+    disposeTextBuffer(&session->input);
+    disposeTextBuffer(&session->output);
+}
@@ -0,0 +1,44 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "game.h"
+#include "board_diff.h"
+#include "text_buffer.h"
+
+/* Limits of input a single client can make the server hold: longer lines
+ * and larger boards close the session. */
+#define MAX_SESSION_LINE_SIZE 4096
+#define MAX_SESSION_BOARD_SIZE 1024
+
+/* Single game hosted by the server. Session is fed with raw bytes
+ * received from its client and produces text which should be sent back.
+ * Protocol is the same as the one of interactive game: board description
+ * followed by a blank line and then commands, each in a new line.
+ * Board is answered in full, followed by a blank line. Every command is
+ * answered with a single line consisting of space-separated triples
+ * "row col square", one for each square changed by the command.
+ * Session is closed when its client exceeds the limits of input. */
+struct Session {
+    Board board;
+    Game game;
+    Position playerPos;
+    MoveStack stack;
+    bool isGameStarted;
+    bool isClosed;
+    TextBuffer input;
+    TextBuffer output;
+};
+
+typedef struct Session Session;
+
+void initSession(Session *session);
+
+void feedSession(Session *session, const char *data, int size);
+
+void disposeSession(Session *session);
+
+static inline bool hasSessionOutput(Session *session) {
+    return session->output.size > 0;
+}
+
+#endif // SESSION_H
@@ -0,0 +1,398 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "text_buffer.h"
+
+#define DEFAULT_SOCKET_PATH "/tmp/sokoban.sock"
+#define MAX_NUM_OF_THREADS 256
+#define MAX_NUM_OF_EVENTS 256
+#define READ_CHUNK_SIZE 4096
+#define NANOSECONDS_IN_SECOND 1000000000LL
+
+/* Game replayed by every session: board description (with terminating
+ * blank line) and commands, each with trailing newline. */
+struct Script {
+    TextBuffer board;
+    char **commands;
+    int numOfCommands;
+};
+
+typedef struct Script Script;
+
+/* Client side of a single session. Next command is sent only after
+ * the answer to the previous one arrives. */
+struct Client {
+    int fd;
+    bool isBoardReceived;
+    int numOfSentCommands;
+    long long sendTime;
+    TextBuffer input;
+};
+
+typedef struct Client Client;
+
+struct LoadThread {
+    pthread_t thread;
+    bool isStarted;
+    const char *path;
+    Script *script;
+    int numOfClients;
+    int numOfRepetitions;
+    long long *latencies;
+    int numOfLatencies;
+    int numOfFailures;
+};
+
+typedef struct LoadThread LoadThread;
+
+static long long getTime() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NANOSECONDS_IN_SECOND + ts.tv_nsec;
+}
+
+static bool sendAll(int fd, const char *text, int size) {
+    while (size > 0) {
+        ssize_t n = send(fd, text, size, MSG_NOSIGNAL);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        text += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool readScript(FILE *file, Script *script) {
+    initTextBuffer(&script->board);
+    script->numOfCommands = 0;
+    int capacity = 16;
+    script->commands = malloc(capacity * sizeof(char *));
+    assert(script->commands != NULL);
+
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    ssize_t size;
+    bool isBoardRead = false;
+    while ((size = getline(&line, &lineCapacity, file)) != -1) {
+        while (size > 0 && (line[size - 1] == '\n' || line[size - 1] == '\r')) {
+            size--;
+        }
+        line[size] = '\0';
+        if (!isBoardRead) {
+            appendToTextBuffer(&script->board, line, size);
+            addToTextBuffer(&script->board, '\n');
+            isBoardRead = size == 0;
+        }
+        else if (strcmp(line, ".") == 0) {
+            break;
+        }
+        else {
+            if (script->numOfCommands == capacity) {
+                capacity *= 2;
+                script->commands = realloc(script->commands, capacity * sizeof(char *));
+                assert(script->commands != NULL);
+            }
+            char *command = malloc(size + 2);
+            assert(command != NULL);
+            memcpy(command, line, size);
+            command[size] = '\n';
+            command[size + 1] = '\0';
+            script->commands[script->numOfCommands++] = command;
+        }
+    }
+    free(line);
+    return isBoardRead;
+}
+
+static int connectToServer(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void recordLatency(LoadThread *load, long long latency) {
+    load->latencies[load->numOfLatencies++] = latency;
+}
+
+/* Sends next command of the script or ends the session if all repetitions
+ * were sent. Returns false if session is finished, failed sends are counted
+ * as failures. */
+static bool sendNextCommand(LoadThread *load, Client *client) {
+    Script *script = load->script;
+    int total = script->numOfCommands * load->numOfRepetitions;
+    if (client->numOfSentCommands == total) {
+        if (!sendAll(client->fd, ".\n", 2)) {
+            load->numOfFailures++;
+        }
+        return false;
+    }
+
+    char *command = script->commands[client->numOfSentCommands % script->numOfCommands];
+    client->sendTime = getTime();
+    client->numOfSentCommands++;
+    if (!sendAll(client->fd, command, (int) strlen(command))) {
+        load->numOfFailures++;
+        return false;
+    }
+    return true;
+}
+
+/* Processes complete lines received by client. Returns false
+ * if session is finished. */
+static bool processAnswers(LoadThread *load, Client *client) {
+    TextBuffer *input = &client->input;
+    int lineStart = 0;
+    bool isActive = true;
+    for (int i = 0; i < input->size && isActive; i++) {
+        if (input->text[i] != '\n') {
+            continue;
+        }
+        if (!client->isBoardReceived) {
+            /* Board is answered in full and ends with a blank line. */
+            if (i == lineStart) {
+                client->isBoardReceived = true;
+                isActive = sendNextCommand(load, client);
+            }
+        }
+        else {
+            recordLatency(load, getTime() - client->sendTime);
+            isActive = sendNextCommand(load, client);
+        }
+        lineStart = i + 1;
+    }
+    consumeTextBuffer(input, lineStart);
+    return isActive;
+}
+
+static void *runLoadThread(void *arg) {
+    LoadThread *load = arg;
+    Script *script = load->script;
+    load->latencies = malloc((size_t) load->numOfClients * script->numOfCommands
+                             * load->numOfRepetitions * sizeof(long long) + 1);
+    assert(load->latencies != NULL);
+    load->numOfLatencies = 0;
+    load->numOfFailures = 0;
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd == -1) {
+        perror("epoll_create1");
+        load->numOfFailures = load->numOfClients;
+        return NULL;
+    }
+
+    Client *clients = malloc(load->numOfClients * sizeof(Client));
+    assert(clients != NULL);
+    int numOfActive = 0;
+    for (int i = 0; i < load->numOfClients; i++) {
+        Client *client = &clients[i];
+        client->fd = connectToServer(load->path);
+        client->isBoardReceived = false;
+        client->numOfSentCommands = 0;
+        initTextBuffer(&client->input);
+        if (client->fd == -1 ||
+            !sendAll(client->fd, script->board.text, script->board.size)) {
+            load->numOfFailures++;
+            continue;
+        }
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = client;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, client->fd, &event) == -1) {
+            perror("epoll_ctl");
+            close(client->fd);
+            client->fd = -1;
+            load->numOfFailures++;
+            continue;
+        }
+        numOfActive++;
+    }
+
+    struct epoll_event events[MAX_NUM_OF_EVENTS];
+    while (numOfActive > 0) {
+        int numOfEvents = epoll_wait(epollFd, events, MAX_NUM_OF_EVENTS, -1);
+        for (int i = 0; i < numOfEvents; i++) {
+            Client *client = events[i].data.ptr;
+            char data[READ_CHUNK_SIZE];
+            ssize_t n = recv(client->fd, data, sizeof(data), 0);
+            bool isActive = n > 0;
+            if (isActive) {
+                appendToTextBuffer(&client->input, data, n);
+                isActive = processAnswers(load, client);
+            }
+            else if (n == -1 && errno == EINTR) {
+                continue;
+            }
+            else {
+                load->numOfFailures++;
+            }
+            if (!isActive) {
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, client->fd, NULL);
+                close(client->fd);
+                client->fd = -1;
+                numOfActive--;
+            }
+        }
+    }
+
+    for (int i = 0; i < load->numOfClients; i++) {
+        if (clients[i].fd != -1) {
+            close(clients[i].fd);
+        }
+        disposeTextBuffer(&clients[i].input);
+    }
+    free(clients);
+    close(epollFd);
+    return NULL;
+}
+
+static int compareLatencies(const void *a, const void *b) {
+    long long x = *(const long long *) a;
+    long long y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+static double getPercentile(long long *sorted, int size, double percentile) {
+    if (size == 0) {
+        return 0.0;
+    }
+    int index = (int) (percentile / 100.0 * (size - 1) + 0.5);
+    return sorted[index] / 1000.0;
+}
+
+static void printUsage(const char *program) {
+    fprintf(stderr, "Usage: %s [-s socket_path] [-c num_of_sessions] "
+                    "[-t num_of_threads] [-r num_of_repetitions] script_file\n", program);
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = DEFAULT_SOCKET_PATH;
+    int numOfSessions = 1000;
+    int numOfThreads = 4;
+    int numOfRepetitions = 10;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:c:t:r:")) != -1) {
+        if (opt == 's') {
+            path = optarg;
+        }
+        else if (opt == 'c') {
+            numOfSessions = atoi(optarg);
+        }
+        else if (opt == 't') {
+            numOfThreads = atoi(optarg);
+        }
+        else if (opt == 'r') {
+            numOfRepetitions = atoi(optarg);
+        }
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc - 1 || numOfSessions < 1 || numOfThreads < 1 ||
+        numOfThreads > MAX_NUM_OF_THREADS || numOfRepetitions < 1) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (numOfThreads > numOfSessions) {
+        numOfThreads = numOfSessions;
+    }
+
+    FILE *file = fopen(argv[optind], "r");
+    if (file == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+    Script script;
+    bool isRead = readScript(file, &script);
+    fclose(file);
+    if (!isRead || script.numOfCommands == 0) {
+        fprintf(stderr, "Script must contain a board followed by commands\n");
+        return 1;
+    }
+
+    LoadThread threads[MAX_NUM_OF_THREADS];
+    long long startTime = getTime();
+    for (int i = 0; i < numOfThreads; i++) {
+        threads[i].path = path;
+        threads[i].script = &script;
+        threads[i].numOfClients = numOfSessions / numOfThreads
+                                  + (i < numOfSessions % numOfThreads ? 1 : 0);
+        threads[i].numOfRepetitions = numOfRepetitions;
+        int result = pthread_create(&threads[i].thread, NULL, runLoadThread, &threads[i]);
+        threads[i].isStarted = result == 0;
+        if (!threads[i].isStarted) {
+            /* Sessions of thread which could not be started are failed. */
+            fprintf(stderr, "pthread_create: %s\n", strerror(result));
+            threads[i].numOfLatencies = 0;
+            threads[i].numOfFailures = threads[i].numOfClients;
+        }
+    }
+
+    int numOfLatencies = 0;
+    int numOfFailures = 0;
+    for (int i = 0; i < numOfThreads; i++) {
+        if (threads[i].isStarted) {
+            pthread_join(threads[i].thread, NULL);
+        }
+        numOfLatencies += threads[i].numOfLatencies;
+        numOfFailures += threads[i].numOfFailures;
+    }
+    long long elapsed = getTime() - startTime;
+
+    long long *latencies = malloc((size_t) numOfLatencies * sizeof(long long) + 1);
+    assert(latencies != NULL);
+    int size = 0;
+    for (int i = 0; i < numOfThreads; i++) {
+        if (threads[i].isStarted) {
+            memcpy(latencies + size, threads[i].latencies,
+                   threads[i].numOfLatencies * sizeof(long long));
+            size += threads[i].numOfLatencies;
+            free(threads[i].latencies);
+        }
+    }
+    qsort(latencies, size, sizeof(long long), compareLatencies);
+
+    double seconds = (double) elapsed / NANOSECONDS_IN_SECOND;
+    printf("sessions: %d, failed: %d\n", numOfSessions, numOfFailures);
+    printf("commands: %d in %.3f s, %.0f commands/s\n",
+           numOfLatencies, seconds, numOfLatencies / seconds);
+    printf("latency us: p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f\n",
+           getPercentile(latencies, size, 50.0), getPercentile(latencies, size, 90.0),
+           getPercentile(latencies, size, 99.0), getPercentile(latencies, size, 99.9),
+           getPercentile(latencies, size, 100.0));
+
+    free(latencies);
+    for (int i = 0; i < script.numOfCommands; i++) {
+        free(script.commands[i]);
+    }
+    free(script.commands);
+    disposeTextBuffer(&script.board);
+
+    return numOfFailures == 0 ? 0 : 1;
+}
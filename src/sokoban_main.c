@@ -1,59 +1,314 @@
 #include <stdio.h>
+#include <unistd.h>
 
 #include "move_stack.h"
 #include "board.h"
 #include "command.h"
 #include "game.h"
+#include "pipeline.h"
+#include "solver.h"
+#include "hint.h"
+#include "external_search.h"
+#include "optimizer.h"
+#include "thread_pool.h"
+#include "warehouse.h"
+#include "text_buffer.h"
 
-#define END_OF_DATA '.'
+#define MAX_NUM_OF_TICK_COMMANDS 64
 
-void readAndExecuteCommands(Game *game) {
+void readAndExecuteCommands(Game *game, int hintTimeBudget) {
     MoveStack stack;
     initMoveStack(&stack);
+    HintSearch hints;
+    bool areHintsStarted = false;
+
+    int c = getchar();
+    while (c != END_OF_DATA) {
+        if (c == HINT_COMMAND) {
+            if (!areHintsStarted) {
+                initHintSearch(&hints, game, hintTimeBudget);
+                areHintsStarted = true;
+            }
+            PushCommand hint;
+            int numOfPushes = getHint(&hints, game, &hint);
+            printHint(&hint, numOfPushes);
+        }
+        else {
+            if (c == UNDO_COMMAND) {
+                if (!isMoveStackEmpty(&stack)) {
+                    executeUndoCommand(game, &stack);
+                }
+            }
+            else {
+                PushCommand pushComm;
+                pushComm.chestNum = getChestNum(c);
+                pushComm.direction = getchar();
+                if (isPushCommandPossible(game, &pushComm)) {
+                    if (isMacroPushCommand(c)) {
+                        executeMacroPushCommand(game, &pushComm, &stack);
+                    }
+                    else {
+                        executePushCommand(game, &pushComm, &stack);
+                    }
+                }
+            }
+            if (areHintsStarted) {
+                rerootHintSearch(&hints, game);
+            }
+            printBoard(game->board);
+        }
+        getchar();
+        c = getchar();
+    }
+
+    if (areHintsStarted) {
+        disposeHintSearch(&hints);
+    }
+    clearMoveStack(&stack);
+}
+
+void printSolution(CommandList *solution) {
+    printf("\n");
+    printCommandList(solution);
+    printf("%c\n", END_OF_DATA);
+}
+
+/* Prints solution of the game as commands, followed by end of data,
+ * so that together with already printed board it forms a valid input. */
+bool solveAndPrintCommands(Game *game) {
+    CommandList solution;
+    initCommandList(&solution);
+
+    SearchStats stats;
+    bool isSolved = solveGame(game, &solution, DEFAULT_MAX_NUM_OF_STATES, &stats);
+    if (isSolved) {
+        printSolution(&solution);
+    }
+    else {
+        fprintf(stderr, "No solution found\n");
+    }
+    fprintf(stderr, "States: %d, bytes/record: %.1f, unused arena: %zu KiB\n",
+            stats.numOfStates, stats.bytesPerRecord, stats.arenaOverhead / 1024);
+
+    disposeCommandList(&solution);
+    return isSolved;
+}
+
+/* Like solveAndPrintCommands, but states are kept on disk. */
+bool solveOnDiskAndPrintCommands(Game *game, long long memoryBudget,
+                                 const char *directory) {
+    CommandList solution;
+    initCommandList(&solution);
+
+    bool isSolved = solveGameOnDisk(game, &solution, memoryBudget, directory);
+    if (isSolved) {
+        printSolution(&solution);
+    }
+    else {
+        fprintf(stderr, "No solution found\n");
+    }
+
+    disposeCommandList(&solution);
+    return isSolved;
+}
+
+/* Replays commands without printing boards, recording states visited by
+ * accepted pushes, then prints optimized commands leading to the same final
+ * state, followed by end of data. Numbers of pushes and moves before and
+ * after optimization are reported on standard error. */
+bool readAndOptimizeCommands(Game *game, int windowDepth) {
+    MoveStack stack;
+    initMoveStack(&stack);
+    OptimizerPath path;
+    initOptimizerPath(&path, game);
 
     int c = getchar();
     while (c != END_OF_DATA) {
         if (c == UNDO_COMMAND) {
             if (!isMoveStackEmpty(&stack)) {
                 executeUndoCommand(game, &stack);
+                removeLastFromOptimizerPath(&path);
             }
         }
-        else {
+        else if (c != HINT_COMMAND) {
             PushCommand pushComm;
             pushComm.chestNum = getChestNum(c);
             pushComm.direction = getchar();
             if (isPushCommandPossible(game, &pushComm)) {
-                executePushCommand(game, &pushComm, &stack);
+                if (isMacroPushCommand(c)) {
+                    executeMacroPushCommand(game, &pushComm, &stack);
+                }
+                else {
+                    executePushCommand(game, &pushComm, &stack);
+                }
+                addGameToOptimizerPath(&path);
             }
         }
-        printBoard(game->board);
         getchar();
         c = getchar();
     }
-
     clearMoveStack(&stack);
+
+    bool isOptimized = path.isOptimizable;
+    if (isOptimized) {
+        int numOfPushes = getOptimizerPathNumOfPushes(&path);
+        int numOfMoves = getOptimizerPathNumOfMoves(&path);
+        optimizePath(&path, windowDepth, getDefaultNumOfPoolThreads());
+
+        CommandList commands;
+        initCommandList(&commands);
+        addOptimizerPathCommands(&path, &commands);
+        printSolution(&commands);
+        disposeCommandList(&commands);
+
+        fprintf(stderr, "Pushes: %d -> %d, moves: %d -> %d\n", numOfPushes,
+                getOptimizerPathNumOfPushes(&path), numOfMoves,
+                getOptimizerPathNumOfMoves(&path));
+    }
+    else {
+        fprintf(stderr, "Level too large to optimize\n");
+    }
+
+    disposeOptimizerPath(&path);
+    return isOptimized;
+}
+
+/* Parses a single worker command, consisting of names of the worker and
+ * the chest followed by direction. Returns false if it is malformed. */
+static bool parseWorkerCommand(const char *token, int size, WorkerCommand *command) {
+    if (size != 3 || !isWorkerSquare(token[0]) || !isChestSquare(token[1])
+        || !isDirectionCommand(token[2])) {
+        return false;
+    }
+    command->workerNum = getWorkerNum(token[0]);
+    command->pushComm.chestNum = getChestNum(token[1]);
+    command->pushComm.direction = token[2];
+    return true;
+}
+
+/* Each line holds commands of a single tick, separated by spaces, each of them
+ * being name of worker followed by a push command. Board with workers
+ * is printed after every tick. */
+void readAndExecuteWorkerCommands(Warehouse *warehouse) {
+    WorkerCommand commands[MAX_NUM_OF_TICK_COMMANDS];
+    TextBuffer line;
+    initTextBuffer(&line);
+
+    int c = getchar();
+    while (c != END_OF_DATA && c != EOF) {
+        /* Whole line is read first, so that a malformed command never
+         * swallows commands of the next tick. */
+        line.size = 0;
+        while (c != '\n' && c != EOF) {
+            addToTextBuffer(&line, (char) c);
+            c = getchar();
+        }
+
+        int numOfCommands = 0;
+        int tokenStart = 0;
+        for (int i = 0; i <= line.size; i++) {
+            if (i < line.size && line.text[i] != ' ') {
+                continue;
+            }
+            if (i > tokenStart && numOfCommands < MAX_NUM_OF_TICK_COMMANDS
+                && parseWorkerCommand(line.text + tokenStart, i - tokenStart,
+                                      &commands[numOfCommands])) {
+                numOfCommands++;
+            }
+            tokenStart = i + 1;
+        }
+
+        executeWorkerCommands(warehouse, commands, numOfCommands);
+        printWarehouse(warehouse);
+        c = getchar();
+    }
+
+    disposeTextBuffer(&line);
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    bool isPipelined = false;
+    bool isSolving = false;
+    bool isOptimizing = false;
+    bool isWarehouse = false;
+    bool isSolvingOnDisk = false;
+    long long memoryBudget = DEFAULT_EXTERNAL_MEMORY_BUDGET_MB * BYTES_IN_MEGABYTE;
+    const char *directory = DEFAULT_EXTERNAL_DIRECTORY;
+    int windowDepth = DEFAULT_OPTIMIZER_WINDOW;
+    int hintTimeBudget = DEFAULT_HINT_TIME_BUDGET;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "emposw:t:M:d:")) != -1) {
+        if (opt == 'p') {
+            isPipelined = true;
+        }
+        else if (opt == 's') {
+            isSolving = true;
+        }
+        else if (opt == 'e') {
+            isSolvingOnDisk = true;
+        }
+        else if (opt == 'M') {
+            memoryBudget = atoll(optarg) * BYTES_IN_MEGABYTE;
+        }
+        else if (opt == 'd') {
+            directory = optarg;
+        }
+        else if (opt == 'm') {
+            isWarehouse = true;
+        }
+        else if (opt == 'o') {
+            isOptimizing = true;
+        }
+        else if (opt == 'w') {
+            windowDepth = atoi(optarg);
+        }
+        else if (opt == 't') {
+            hintTimeBudget = atoi(optarg);
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-p | -s | -e [-M memory_budget_mb] [-d directory]"
+                            " | -o [-w window_depth] | -m] [-t hint_time_budget_ms]\n", argv[0]);
+            return 1;
+        }
+    }
+
     Board board;
     initBoard(&board);
     readInitialBoardState(&board);
 
     printBoard(&board);
 
-    Game game;
-    game.board = &board;
-
-    initChestsPositions(game.chestsPos);
-    findChestsPositions(&game);
+    if (isWarehouse) {
+        Warehouse warehouse;
+        initWarehouse(&warehouse, &board);
+        readAndExecuteWorkerCommands(&warehouse);
+        disposeWarehouse(&warehouse);
+        return 0;
+    }
 
+    Game game;
     Position playerPos;
-    findPlayerPosition(&game, &playerPos);
-    game.playerPos = &playerPos;
+    initGame(&game, &board, &playerPos);
 
-    readAndExecuteCommands(&game);
+    int result = 0;
+    if (isSolving) {
+        result = solveAndPrintCommands(&game) ? 0 : 1;
+    }
+    else if (isSolvingOnDisk) {
+        result = solveOnDiskAndPrintCommands(&game, memoryBudget, directory) ? 0 : 1;
+    }
+    else if (isOptimizing) {
+        result = readAndOptimizeCommands(&game, windowDepth) ? 0 : 1;
+    }
+    else if (isPipelined) {
+        readAndExecuteCommandsPipelined(&game, hintTimeBudget);
+    }
+    else {
+        readAndExecuteCommands(&game, hintTimeBudget);
+    }
 
     disposeGame(&game);
 
-    return 0;
+    return result;
 }
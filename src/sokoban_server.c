@@ -0,0 +1,427 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "session.h"
+
+#define DEFAULT_SOCKET_PATH "/tmp/sokoban.sock"
+#define MAX_NUM_OF_WORKERS 256
+#define MAX_NUM_OF_EVENTS 256
+#define READ_CHUNK_SIZE 4096
+/* Reading from a client stops while this much of answers to it is pending
+ * and resumes once all of them are sent, so a client which does not read
+ * cannot make the server hold unbounded output. */
+#define MAX_PENDING_OUTPUT_SIZE (64 * 1024)
+
+/* Session together with the socket it is played over. Connection is created,
+ * used and disposed only by the worker it was handed to, so sessions are
+ * never shared between threads and need no locking. Events are the ones
+ * connection is currently registered for. */
+struct Connection {
+    int fd;
+    uint32_t events;
+    bool isReadingPaused;
+    Session session;
+    struct Connection *prev;
+    struct Connection *next;
+};
+
+typedef struct Connection Connection;
+
+/* Worker runs its own epoll event loop over connections handed to it
+ * by the acceptor through a pipe. Closing the pipe stops the worker. */
+struct Worker {
+    pthread_t thread;
+    int epollFd;
+    int handOffFds[2];
+    Connection *connections;
+};
+
+typedef struct Worker Worker;
+
+static void closeConnection(Worker *worker, Connection *conn) {
+    epoll_ctl(worker->epollFd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+
+    if (conn->prev != NULL) {
+        conn->prev->next = conn->next;
+    }
+    else {
+        worker->connections = conn->next;
+    }
+    if (conn->next != NULL) {
+        conn->next->prev = conn->prev;
+    }
+
+    disposeSession(&conn->session);
+    free(conn);
+}
+
+static void addConnection(Worker *worker, int fd) {
+    Connection *conn = malloc(sizeof(Connection));
+    assert(conn != NULL);
+    conn->fd = fd;
+    conn->events = EPOLLIN | EPOLLRDHUP;
+    conn->isReadingPaused = false;
+    initSession(&conn->session);
+
+    conn->prev = NULL;
+    conn->next = worker->connections;
+    if (worker->connections != NULL) {
+        worker->connections->prev = conn;
+    }
+    worker->connections = conn;
+
+    struct epoll_event event;
+    event.events = conn->events;
+    event.data.ptr = conn;
+    if (epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, fd, &event) == -1) {
+        perror("epoll_ctl");
+        closeConnection(worker, conn);
+    }
+}
+
+/* Sends as much of pending output as socket accepts. Returns false
+ * if connection is broken. */
+static bool flushConnection(Connection *conn) {
+    TextBuffer *output = &conn->session.output;
+    int sent = 0;
+    while (sent < output->size) {
+        ssize_t n = send(conn->fd, output->text + sent, output->size - sent,
+                         MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += n;
+        }
+        else if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        else {
+            return false;
+        }
+    }
+    consumeTextBuffer(output, sent);
+    return true;
+}
+
+/* Registers connection for input unless its reading is paused or session
+ * is closed, and for output while there is some pending. Returns false
+ * if registration failed. */
+static bool updateConnectionEvents(Worker *worker, Connection *conn) {
+    int outputSize = conn->session.output.size;
+    if (outputSize >= MAX_PENDING_OUTPUT_SIZE) {
+        conn->isReadingPaused = true;
+    }
+    else if (outputSize == 0) {
+        conn->isReadingPaused = false;
+    }
+
+    uint32_t events = 0;
+    if (!conn->isReadingPaused && !conn->session.isClosed) {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (outputSize > 0) {
+        events |= EPOLLOUT;
+    }
+    if (events == conn->events) {
+        return true;
+    }
+
+    struct epoll_event event;
+    event.events = events;
+    event.data.ptr = conn;
+    if (epoll_ctl(worker->epollFd, EPOLL_CTL_MOD, conn->fd, &event) == -1) {
+        perror("epoll_ctl");
+        return false;
+    }
+    conn->events = events;
+    return true;
+}
+
+/* Reads everything available, or until too much output is pending, and
+ * feeds it to the session. Returns false if peer closed connection or it
+ * is broken. */
+static bool readConnection(Connection *conn) {
+    char data[READ_CHUNK_SIZE];
+    while (!conn->session.isClosed
+           && conn->session.output.size < MAX_PENDING_OUTPUT_SIZE) {
+        ssize_t n = recv(conn->fd, data, sizeof(data), 0);
+        if (n > 0) {
+            feedSession(&conn->session, data, n);
+        }
+        else if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void handleConnectionEvent(Worker *worker, Connection *conn, uint32_t events) {
+    bool isAlive = (events & EPOLLERR) == 0;
+    if (isAlive && !conn->isReadingPaused
+        && (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) {
+        isAlive = readConnection(conn);
+    }
+    /* Answers are sent even if peer already shut down its writing side. */
+    if (hasSessionOutput(&conn->session) && !flushConnection(conn)) {
+        isAlive = false;
+    }
+    if (!isAlive || (conn->session.isClosed && !hasSessionOutput(&conn->session))
+        || !updateConnectionEvents(worker, conn)) {
+        closeConnection(worker, conn);
+    }
+}
+
+/* Accepts connections handed off by the acceptor. Returns false
+ * when the acceptor closed the pipe. */
+static bool receiveHandOffs(Worker *worker) {
+    int fd;
+    ssize_t n;
+    while ((n = read(worker->handOffFds[0], &fd, sizeof(fd))) == sizeof(fd)) {
+        addConnection(worker, fd);
+    }
+    return n != 0;
+}
+
+static void *runWorker(void *arg) {
+    Worker *worker = arg;
+    struct epoll_event events[MAX_NUM_OF_EVENTS];
+
+    bool isRunning = true;
+    while (isRunning) {
+        int numOfEvents = epoll_wait(worker->epollFd, events, MAX_NUM_OF_EVENTS, -1);
+        for (int i = 0; i < numOfEvents; i++) {
+            if (events[i].data.ptr == NULL) {
+                isRunning = receiveHandOffs(worker) && isRunning;
+            }
+            else {
+                handleConnectionEvent(worker, events[i].data.ptr, events[i].events);
+            }
+        }
+    }
+
+    while (worker->connections != NULL) {
+        closeConnection(worker, worker->connections);
+    }
+    return NULL;
+}
+
+/* Returns false if worker could not be started. */
+static bool startWorker(Worker *worker) {
+    worker->connections = NULL;
+    worker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (worker->epollFd == -1) {
+        perror("epoll_create1");
+        return false;
+    }
+    if (pipe2(worker->handOffFds, O_CLOEXEC | O_NONBLOCK) == -1) {
+        perror("pipe2");
+        close(worker->epollFd);
+        return false;
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    int result = epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, worker->handOffFds[0], &event);
+    if (result == -1) {
+        perror("epoll_ctl");
+    }
+    else {
+        result = pthread_create(&worker->thread, NULL, runWorker, worker);
+        if (result != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(result));
+        }
+    }
+    if (result != 0) {
+        close(worker->handOffFds[0]);
+        close(worker->handOffFds[1]);
+        close(worker->epollFd);
+        return false;
+    }
+    return true;
+}
+
+static void stopWorker(Worker *worker) {
+    close(worker->handOffFds[1]);
+    pthread_join(worker->thread, NULL);
+    close(worker->handOffFds[0]);
+    close(worker->epollFd);
+}
+
+static void stopWorkers(Worker *workers, int numOfWorkers) {
+    for (int i = 0; i < numOfWorkers; i++) {
+        stopWorker(&workers[i]);
+    }
+}
+
+static int openListeningSocket(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path is too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) == -1 ||
+        listen(fd, SOMAXCONN) == -1) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Accepts all pending connections and hands them off to workers
+ * in round-robin order. */
+static void acceptConnections(int listenFd, Worker workers[], int numOfWorkers,
+                              int *nextWorker) {
+    int fd;
+    while ((fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+        Worker *worker = &workers[*nextWorker];
+        if (write(worker->handOffFds[1], &fd, sizeof(fd)) != sizeof(fd)) {
+            close(fd);
+        }
+        *nextWorker = (*nextWorker + 1) % numOfWorkers;
+    }
+}
+
+/* Returns epoll descriptor of the acceptor, watching for connections and
+ * signals, or -1 if it could not be created. */
+static int openAcceptorEpoll(int listenFd, int signalFd) {
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd == -1) {
+        perror("epoll_create1");
+        return -1;
+    }
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) == -1) {
+        perror("epoll_ctl");
+        close(epollFd);
+        return -1;
+    }
+    event.data.fd = signalFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &event) == -1) {
+        perror("epoll_ctl");
+        close(epollFd);
+        return -1;
+    }
+    return epollFd;
+}
+
+static void printUsage(const char *program) {
+    fprintf(stderr, "Usage: %s [-s socket_path] [-w num_of_workers]\n", program);
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = DEFAULT_SOCKET_PATH;
+    int numOfWorkers = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:w:")) != -1) {
+        if (opt == 's') {
+            path = optarg;
+        }
+        else if (opt == 'w') {
+            numOfWorkers = atoi(optarg);
+        }
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (numOfWorkers < 1) {
+        numOfWorkers = 1;
+    }
+    else if (numOfWorkers > MAX_NUM_OF_WORKERS) {
+        numOfWorkers = MAX_NUM_OF_WORKERS;
+    }
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    int signalFd = signalfd(-1, &signals, SFD_CLOEXEC);
+    if (signalFd == -1) {
+        perror("signalfd");
+        return 1;
+    }
+
+    int listenFd = openListeningSocket(path);
+    if (listenFd == -1) {
+        close(signalFd);
+        return 1;
+    }
+
+    Worker workers[MAX_NUM_OF_WORKERS];
+    for (int i = 0; i < numOfWorkers; i++) {
+        if (!startWorker(&workers[i])) {
+            stopWorkers(workers, i);
+            close(listenFd);
+            close(signalFd);
+            unlink(path);
+            return 1;
+        }
+    }
+
+    int epollFd = openAcceptorEpoll(listenFd, signalFd);
+    if (epollFd == -1) {
+        stopWorkers(workers, numOfWorkers);
+        close(listenFd);
+        close(signalFd);
+        unlink(path);
+        return 1;
+    }
+
+    int nextWorker = 0;
+    bool isRunning = true;
+    while (isRunning) {
+        struct epoll_event events[2];
+        int numOfEvents = epoll_wait(epollFd, events, 2, -1);
+        for (int i = 0; i < numOfEvents; i++) {
+            if (events[i].data.fd == listenFd) {
+                acceptConnections(listenFd, workers, numOfWorkers, &nextWorker);
+            }
+            else {
+                isRunning = false;
+            }
+        }
+    }
+
+    stopWorkers(workers, numOfWorkers);
+    close(epollFd);
+    close(listenFd);
+    close(signalFd);
+    unlink(path);
+
+    return 0;
+}
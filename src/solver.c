@@ -0,0 +1,618 @@
+#include "solver.h"
+#include "state_store.h"
+
+static void computeGoalDistances(Solver *solver) {
+    /* Chest can be pushed from a cell to a storage location in as many pushes
+     * as it takes to pull it from there, with no other chests. */
+    for (int i = 0; i < solver->numOfCells; i++) {
+        solver->goalDistances[i] = NO_DISTANCE;
+    }
+
+    int size = 0;
+    for (int i = 0; i < solver->numOfCells; i++) {
+        if (isFloorSearchCell(solver, i) && isGoalSearchCell(solver, i)) {
+            solver->goalDistances[i] = 0;
+            solver->queue[size] = i;
+            size++;
+        }
+    }
+
+    for (int i = 0; i < size; i++) {
+        int cell = solver->queue[i];
+        for (int d = 0; d < NUM_OF_DIRECTIONS; d++) {
+            int stride = solver->strides[d];
+            int pulledTo = cell + stride;
+            if (isFloorSearchCell(solver, pulledTo)
+                && isFloorSearchCell(solver, pulledTo + stride)
+                && solver->goalDistances[pulledTo] == NO_DISTANCE) {
+                solver->goalDistances[pulledTo] = solver->goalDistances[cell] + 1;
+                solver->queue[size] = pulledTo;
+                size++;
+            }
+        }
+    }
+}
+
+bool initSolver(Solver *solver, Game *game) {
+    solver->analysis = getLevelAnalysis(game);
+    solver->numOfCells = solver->analysis->numOfRows * solver->analysis->numOfCols;
+    if (solver->numOfCells > MAX_NUM_OF_SEARCH_CELLS) {
+        return false;
+    }
+
+    int numOfCols = solver->analysis->numOfCols;
+    solver->strides[0] = -numOfCols;
+    solver->directions[0] = UP;
+    solver->strides[1] = 1;
+    solver->directions[1] = RIGHT;
+    solver->strides[2] = numOfCols;
+    solver->directions[2] = DOWN;
+    solver->strides[3] = -1;
+    solver->directions[3] = LEFT;
+
+    solver->numOfChests = 0;
+    for (int i = 0; i < NUM_OF_CHESTS; i++) {
+        if (getChestPosition(game, i) != NULL) {
+            solver->numOfChests++;
+        }
+    }
+    solver->numOfGoals = 0;
+    for (int i = 0; i < solver->numOfCells; i++) {
+        if (isGoalSearchCell(solver, i)) {
+            solver->numOfGoals++;
+        }
+    }
+
+    solver->goalDistances = malloc(solver->numOfCells * sizeof(int));
+    assert(solver->goalDistances != NULL);
+    solver->isChest = calloc(solver->numOfCells, sizeof(bool));
+    assert(solver->isChest != NULL);
+    solver->reachMarks = calloc(solver->numOfCells, sizeof(int));
+    assert(solver->reachMarks != NULL);
+    solver->reachMark = 0;
+    solver->areaMarks = calloc(solver->numOfCells, sizeof(int));
+    assert(solver->areaMarks != NULL);
+    solver->areaMark = 0;
+    solver->queue = malloc(solver->numOfCells * sizeof(int));
+    assert(solver->queue != NULL);
+    int maxKeySize = PACKED_PLAYER_SIZE
+                     + (solver->numOfCells + BITS_IN_BYTE - 1) / BITS_IN_BYTE;
+    solver->successorKeys = malloc(MAX_NUM_OF_SUCCESSORS * maxKeySize);
+    assert(solver->successorKeys != NULL);
+
+    computeGoalDistances(solver);
+    return true;
+}
+
+void disposeSolver(Solver *solver) {
+    free(solver->goalDistances);
+    free(solver->isChest);
+    free(solver->reachMarks);
+    free(solver->areaMarks);
+    free(solver->queue);
+    free(solver->successorKeys);
+}
+
+static int getCell(Solver *solver, Position *pos) {
+    return getCellIndex(solver->analysis, pos->row, pos->col);
+}
+
+static void setChests(Solver *solver, SearchState *state, bool isChest) {
+    for (int i = 0; i < solver->numOfChests; i++) {
+        solver->isChest[state->chests[i]] = isChest;
+    }
+}
+
+static bool isFreeSearchCell(Solver *solver, int cell) {
+    return isFloorSearchCell(solver, cell) && !solver->isChest[cell];
+}
+
+/* Flood fills area player standing at start can walk to, marking its cells
+ * with given mark. Returns the smallest cell of the area. */
+static int fillPlayerArea(Solver *solver, int start, int *marks, int mark) {
+    int smallest = start;
+    marks[start] = mark;
+    solver->queue[0] = start;
+    int size = 1;
+    for (int i = 0; i < size; i++) {
+        int cell = solver->queue[i];
+        if (cell < smallest) {
+            smallest = cell;
+        }
+        for (int d = 0; d < NUM_OF_DIRECTIONS; d++) {
+            int neighbor = cell + solver->strides[d];
+            if (isFreeSearchCell(solver, neighbor) && marks[neighbor] != mark) {
+                marks[neighbor] = mark;
+                solver->queue[size] = neighbor;
+                size++;
+            }
+        }
+    }
+    return smallest;
+}
+
+static int normalizePlayerCell(Solver *solver, int cell) {
+    solver->areaMark++;
+    return fillPlayerArea(solver, cell, solver->areaMarks, solver->areaMark);
+}
+
+/* Marks cells player can walk to in given state with current reach mark.
+ * Chests of the state have to be set. */
+static void markReachableCells(Solver *solver, SearchState *state) {
+    solver->reachMark++;
+    fillPlayerArea(solver, state->player, solver->reachMarks, solver->reachMark);
+}
+
+static bool isReachableCell(Solver *solver, int cell) {
+    return isFloorSearchCell(solver, cell) && solver->reachMarks[cell] == solver->reachMark;
+}
+
+void getGameSearchState(Solver *solver, Game *game, SearchState *state) {
+    initSearchState(state);
+    int size = 0;
+    for (int i = 0; i < NUM_OF_CHESTS; i++) {
+        Position *chestPos = getChestPosition(game, i);
+        if (chestPos != NULL) {
+            state->chests[size] = (int16_t) getCell(solver, chestPos);
+            size++;
+        }
+    }
+    sortSearchStateChests(state, solver->numOfChests);
+
+    setChests(solver, state, true);
+    state->player = (int16_t) normalizePlayerCell(solver, getCell(solver, game->playerPos));
+    setChests(solver, state, false);
+}
+
+bool isSolvedSearchState(Solver *solver, SearchState *state) {
+    for (int i = 0; i < solver->numOfChests; i++) {
+        if (!isGoalSearchCell(solver, state->chests[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int getSearchStateHeuristic(Solver *solver, SearchState *state) {
+    int heuristic = 0;
+    for (int i = 0; i < solver->numOfChests; i++) {
+        if (isDeadSearchCell(solver, state->chests[i])) {
+            return NO_DISTANCE;
+        }
+        heuristic += solver->goalDistances[state->chests[i]];
+    }
+    return heuristic;
+}
+
+static bool isSquareFreeForSearchChest(void *context, int row, int col) {
+    Solver *solver = context;
+    LevelAnalysis *analysis = solver->analysis;
+    return isCellInRange(analysis, row, col)
+           && isFreeSearchCell(solver, getCellIndex(analysis, row, col));
+}
+
+/* Sets successor to state with its chest of given number pushed to given
+ * cell. Chests of the state have to be set. */
+static void addPushSuccessor(Solver *solver, SearchState *state, int chestNum,
+                             int pushedTo, int stride, SearchState *successor) {
+    int chest = state->chests[chestNum];
+    *successor = *state;
+    moveSearchStateChest(successor, solver->numOfChests, chestNum, pushedTo);
+    solver->isChest[chest] = false;
+    solver->isChest[pushedTo] = true;
+    successor->player = (int16_t) normalizePlayerCell(solver, pushedTo - stride);
+    solver->isChest[pushedTo] = false;
+    solver->isChest[chest] = true;
+}
+
+int expandPushes(Solver *solver, SearchState *state, SearchState successors[]) {
+    setChests(solver, state, true);
+    markReachableCells(solver, state);
+
+    int size = 0;
+    for (int i = 0; i < solver->numOfChests; i++) {
+        int chest = state->chests[i];
+        for (int d = 0; d < NUM_OF_DIRECTIONS; d++) {
+            int stride = solver->strides[d];
+            if (!isReachableCell(solver, chest - stride)
+                || !isFreeSearchCell(solver, chest + stride)
+                || isDeadSearchCell(solver, chest + stride)) {
+                continue;
+            }
+
+            /* Chest stopped inside a tunnel may be needed there, so single
+             * push is generated as well as the macro push. */
+            addPushSuccessor(solver, state, i, chest + stride, stride,
+                             &successors[size]);
+            size++;
+
+            Position chestPos;
+            chestPos.row = getCellRow(solver, chest);
+            chestPos.col = getCellCol(solver, chest);
+            int length = getMacroPushLength(solver->analysis, &chestPos,
+                                            solver->directions[d],
+                                            isSquareFreeForSearchChest, solver);
+            int pushedTo = chest + length * stride;
+            if (length > 1 && !isDeadSearchCell(solver, pushedTo)) {
+                addPushSuccessor(solver, state, i, pushedTo, stride, &successors[size]);
+                size++;
+            }
+        }
+    }
+
+    setChests(solver, state, false);
+    return size;
+}
+
+int expandPulls(Solver *solver, SearchState *state, SearchState successors[]) {
+    setChests(solver, state, true);
+    markReachableCells(solver, state);
+
+    int size = 0;
+    for (int i = 0; i < solver->numOfChests; i++) {
+        int chest = state->chests[i];
+        for (int d = 0; d < NUM_OF_DIRECTIONS; d++) {
+            int stride = solver->strides[d];
+            int playerCell = chest + stride;
+            if (!isReachableCell(solver, playerCell)
+                || !isFreeSearchCell(solver, playerCell + stride)) {
+                continue;
+            }
+
+            SearchState *successor = &successors[size];
+            *successor = *state;
+            moveSearchStateChest(successor, solver->numOfChests, i, playerCell);
+            solver->isChest[chest] = false;
+            solver->isChest[playerCell] = true;
+            successor->player = (int16_t) normalizePlayerCell(solver, playerCell + stride);
+            solver->isChest[playerCell] = false;
+            solver->isChest[chest] = true;
+            size++;
+        }
+    }
+
+    setChests(solver, state, false);
+    return size;
+}
+
+int getSolvedSearchStates(Solver *solver, SearchState states[]) {
+    if (solver->numOfGoals != solver->numOfChests) {
+        return 0;
+    }
+
+    SearchState solved;
+    initSearchState(&solved);
+    int numOfChests = 0;
+    for (int i = 0; i < solver->numOfCells; i++) {
+        if (isFloorSearchCell(solver, i) && isGoalSearchCell(solver, i)) {
+            solved.chests[numOfChests] = (int16_t) i;
+            numOfChests++;
+        }
+    }
+
+    setChests(solver, &solved, true);
+    solver->areaMark++;
+    int size = 0;
+    for (int i = 0; i < solver->numOfCells; i++) {
+        if (isFreeSearchCell(solver, i) && solver->areaMarks[i] != solver->areaMark) {
+            states[size] = solved;
+            states[size].player = (int16_t) fillPlayerArea(solver, i, solver->areaMarks,
+                                                           solver->areaMark);
+            size++;
+        }
+    }
+    setChests(solver, &solved, false);
+    return size;
+}
+
+void initChestAtCell(Solver *solver, Game *game, int chestAtCell[]) {
+    for (int i = 0; i < solver->numOfCells; i++) {
+        chestAtCell[i] = -1;
+    }
+    for (int i = 0; i < NUM_OF_CHESTS; i++) {
+        Position *chestPos = getChestPosition(game, i);
+        if (chestPos != NULL) {
+            chestAtCell[getCell(solver, chestPos)] = i;
+        }
+    }
+}
+
+/* Finds cells which the chest moved between state and its successor next
+ * was moved from and to. */
+static void findMovedChest(Solver *solver, SearchState *state, SearchState *next,
+                           int *from, int *to) {
+    *from = NO_CELL;
+    *to = NO_CELL;
+    int i = 0;
+    int j = 0;
+    while (i < solver->numOfChests || j < solver->numOfChests) {
+        if (j == solver->numOfChests ||
+            (i < solver->numOfChests && state->chests[i] < next->chests[j])) {
+            *from = state->chests[i];
+            i++;
+        }
+        else if (i == solver->numOfChests || next->chests[j] < state->chests[i]) {
+            *to = next->chests[j];
+            j++;
+        }
+        else {
+            i++;
+            j++;
+        }
+    }
+    assert(*from != NO_CELL && *to != NO_CELL);
+}
+
+/* Returns stride of pushes moving chest from one cell to the other
+ * and sets direction of them. */
+static int getStepStride(Solver *solver, int from, int to, char *direction) {
+    int delta = to - from;
+    if (getCellRow(solver, from) == getCellRow(solver, to)) {
+        *direction = delta > 0 ? RIGHT : LEFT;
+        return delta > 0 ? 1 : -1;
+    }
+    *direction = delta > 0 ? DOWN : UP;
+    return delta > 0 ? solver->analysis->numOfCols : -solver->analysis->numOfCols;
+}
+
+void addStepCommands(Solver *solver, SearchState *state, SearchState *next,
+                     int chestAtCell[], CommandList *commands) {
+    int from;
+    int to;
+    findMovedChest(solver, state, next, &from, &to);
+    char direction;
+    int stride = getStepStride(solver, from, to, &direction);
+
+    int chestNum = chestAtCell[from];
+    for (int cell = from; cell != to; cell += stride) {
+        addToCommandList(commands, chestNum, direction);
+    }
+    chestAtCell[from] = -1;
+    chestAtCell[to] = chestNum;
+}
+
+int getStepNumOfPushes(Solver *solver, SearchState *state, SearchState *next) {
+    int from;
+    int to;
+    findMovedChest(solver, state, next, &from, &to);
+    char direction;
+    return (to - from) / getStepStride(solver, from, to, &direction);
+}
+
+/* Returns number of steps of the shortest walk between given cells, with
+ * chests set, or NO_DISTANCE if there is none. Queue is processed layer
+ * by layer, so no distance array is needed. */
+static int getWalkDistance(Solver *solver, int from, int to) {
+    solver->reachMark++;
+    solver->reachMarks[from] = solver->reachMark;
+    solver->queue[0] = from;
+    int size = 1;
+    int layerStart = 0;
+    for (int distance = 0; layerStart < size; distance++) {
+        int layerEnd = size;
+        for (int i = layerStart; i < layerEnd; i++) {
+            int cell = solver->queue[i];
+            if (cell == to) {
+                return distance;
+            }
+            for (int d = 0; d < NUM_OF_DIRECTIONS; d++) {
+                int neighbor = cell + solver->strides[d];
+                if (isFreeSearchCell(solver, neighbor)
+                    && solver->reachMarks[neighbor] != solver->reachMark) {
+                    solver->reachMarks[neighbor] = solver->reachMark;
+                    solver->queue[size] = neighbor;
+                    size++;
+                }
+            }
+        }
+        layerStart = layerEnd;
+    }
+    return NO_DISTANCE;
+}
+
+int getStepNumOfMoves(Solver *solver, SearchState *state, SearchState *next,
+                      int *playerCell) {
+    int from;
+    int to;
+    findMovedChest(solver, state, next, &from, &to);
+    char direction;
+    int stride = getStepStride(solver, from, to, &direction);
+
+    setChests(solver, state, true);
+    int distance = getWalkDistance(solver, *playerCell, from - stride);
+    setChests(solver, state, false);
+    assert(distance != NO_DISTANCE);
+
+    *playerCell = to - stride;
+    return distance + (to - from) / stride;
+}
+
+/* Expands single layer of one side of bidirectional search. Returns index
+ * of state of this side at which it met the other side, -1 if it did not.
+ * Keys of all successors of a state are hashed and their slots prefetched
+ * before any of them is looked up. */
+static int expandLayer(Solver *solver, StateStore *store, StateStore *other,
+                       bool isForward, int layerStart, int layerEnd, int *otherIndex) {
+    SearchState successors[MAX_NUM_OF_SUCCESSORS];
+    uint64_t hashes[MAX_NUM_OF_SUCCESSORS];
+    unsigned char *keys = solver->successorKeys;
+
+    int result = -1;
+    for (int i = layerStart; i < layerEnd && result == -1; i++) {
+        SearchState state;
+        getStoredState(store, i, &state);
+        int size = isForward ? expandPushes(solver, &state, successors)
+                             : expandPulls(solver, &state, successors);
+        for (int j = 0; j < size; j++) {
+            unsigned char *key = keys + j * store->keySize;
+            packStateKey(store, &successors[j], key);
+            hashes[j] = hashStateKey(store, key);
+            prefetchStateKey(store, hashes[j]);
+            if (other != NULL) {
+                prefetchStateKey(other, hashes[j]);
+            }
+        }
+
+        for (int j = 0; j < size && result == -1; j++) {
+            unsigned char *key = keys + j * store->keySize;
+            if (findStateKey(store, key, hashes[j]) != NO_STORED_STATE) {
+                continue;
+            }
+            int index = addStateKey(store, key, hashes[j], i);
+            if (other != NULL) {
+                *otherIndex = findStateKey(other, key, hashes[j]);
+                if (*otherIndex != NO_STORED_STATE) {
+                    result = index;
+                }
+            }
+            else if (isSolvedSearchState(solver, &successors[j])) {
+                result = index;
+            }
+        }
+    }
+
+    return result;
+}
+
+/* Adds commands along the path from the initial state to the meeting state
+ * in forward table and then from it to the solved state in backward table. */
+static void addPathCommands(Solver *solver, Game *game, StateStore *forward,
+                            int forwardIndex, StateStore *backward,
+                            int backwardIndex, CommandList *solution) {
+    int forwardLength = 0;
+    for (int i = forwardIndex; i != NO_PARENT; i = getStoredParent(forward, i)) {
+        forwardLength++;
+    }
+    int backwardLength = 0;
+    if (backward != NULL) {
+        for (int i = getStoredParent(backward, backwardIndex); i != NO_PARENT;
+             i = getStoredParent(backward, i)) {
+            backwardLength++;
+        }
+    }
+
+    int length = forwardLength + backwardLength;
+    SearchState *path = malloc(length * sizeof(SearchState));
+    assert(path != NULL);
+    int position = forwardLength;
+    for (int i = forwardIndex; i != NO_PARENT; i = getStoredParent(forward, i)) {
+        position--;
+        getStoredState(forward, i, &path[position]);
+    }
+    position = forwardLength;
+    if (backward != NULL) {
+        for (int i = getStoredParent(backward, backwardIndex); i != NO_PARENT;
+             i = getStoredParent(backward, i)) {
+            getStoredState(backward, i, &path[position]);
+            position++;
+        }
+    }
+
+    int *chestAtCell = malloc(solver->numOfCells * sizeof(int));
+    assert(chestAtCell != NULL);
+    initChestAtCell(solver, game, chestAtCell);
+    for (int i = 0; i + 1 < length; i++) {
+        addStepCommands(solver, &path[i], &path[i + 1], chestAtCell, solution);
+    }
+
+    free(chestAtCell);
+    free(path);
+}
+
+bool solveGame(Game *game, CommandList *solution, int maxNumOfStates,
+               SearchStats *stats) {
+    if (stats != NULL) {
+        stats->numOfStates = 0;
+        stats->bytesPerRecord = 0.0;
+        stats->arenaOverhead = 0;
+    }
+
+    Solver solver;
+    if (!initSolver(&solver, game)) {
+        return false;
+    }
+
+    SearchState start;
+    getGameSearchState(&solver, game, &start);
+    if (isSolvedSearchState(&solver, &start)) {
+        disposeSolver(&solver);
+        return true;
+    }
+
+    StatePacker packer;
+    initStatePacker(&packer, &solver);
+    StateStore forward;
+    initStateStore(&forward, &packer, solver.numOfChests);
+    addStoredState(&forward, &start, NO_PARENT);
+
+    /* Backward search is possible only when every storage location
+     * has to be occupied in the end. */
+    StateStore backward;
+    initStateStore(&backward, &packer, solver.numOfChests);
+    SearchState *solvedStates = malloc(solver.numOfCells * sizeof(SearchState));
+    assert(solvedStates != NULL);
+    int numOfSolvedStates = getSolvedSearchStates(&solver, solvedStates);
+    for (int i = 0; i < numOfSolvedStates; i++) {
+        addStoredState(&backward, &solvedStates[i], NO_PARENT);
+    }
+    free(solvedStates);
+    bool isBidirectional = backward.size > 0;
+
+    int forwardIndex = -1;
+    int backwardIndex = -1;
+    if (isBidirectional) {
+        backwardIndex = findStoredState(&backward, &start);
+        if (backwardIndex != NO_STORED_STATE) {
+            forwardIndex = 0;
+        }
+    }
+
+    int forwardStart = 0;
+    int backwardStart = 0;
+    while (forwardIndex == -1) {
+        int forwardSize = forward.size - forwardStart;
+        int backwardSize = isBidirectional ? backward.size - backwardStart : 0;
+        if ((forwardSize == 0 && backwardSize == 0)
+            || forward.size + backward.size > maxNumOfStates) {
+            break;
+        }
+
+        if (backwardSize > 0 && (forwardSize == 0 || backwardSize < forwardSize)) {
+            int layerEnd = backward.size;
+            int index = expandLayer(&solver, &backward, &forward, false,
+                                    backwardStart, layerEnd, &forwardIndex);
+            if (index != -1) {
+                backwardIndex = index;
+            }
+            backwardStart = layerEnd;
+        }
+        else {
+            int layerEnd = forward.size;
+            forwardIndex = expandLayer(&solver, &forward,
+                                       isBidirectional ? &backward : NULL, true,
+                                       forwardStart, layerEnd, &backwardIndex);
+            forwardStart = layerEnd;
+        }
+    }
+
+    bool isSolved = forwardIndex != -1;
+    if (isSolved) {
+        addPathCommands(&solver, game, &forward, forwardIndex,
+                        isBidirectional ? &backward : NULL, backwardIndex, solution);
+    }
+
+    if (stats != NULL) {
+        stats->numOfStates = forward.size + backward.size;
+        stats->bytesPerRecord = (getStateStoreBytesPerRecord(&forward) * forward.size
+                                 + getStateStoreBytesPerRecord(&backward) * backward.size)
+                                / stats->numOfStates;
+        stats->arenaOverhead = getStateStoreArenaOverhead(&forward)
+                               + getStateStoreArenaOverhead(&backward);
+    }
+
+    disposeStateStore(&forward);
+    disposeStateStore(&backward);
+    disposeStatePacker(&packer);
+    disposeSolver(&solver);
+    return isSolved;
+}
@@ -0,0 +1,130 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "game.h"
+#include "search_state.h"
+#include "state_table.h"
+#include "command_list.h"
+
+#define NUM_OF_DIRECTIONS 4
+/* Every push of a chest may be followed by a macro push in its direction. */
+#define MAX_NUM_OF_SUCCESSORS (2 * NUM_OF_DIRECTIONS * NUM_OF_CHESTS)
+#define DEFAULT_MAX_NUM_OF_STATES 4000000
+#define NO_DISTANCE (-1)
+
+/* Level as seen by searches, built from game with its level analysis.
+ * Scratch arrays are reused between expansions, marks are cleared by
+ * advancing the current mark instead of rewriting the arrays. */
+struct Solver {
+    LevelAnalysis *analysis;
+    int numOfCells;
+    int numOfChests;
+    int numOfGoals;
+    int strides[NUM_OF_DIRECTIONS];
+    char directions[NUM_OF_DIRECTIONS];
+    /* Least number of pushes needed to get a chest from the cell to any
+     * storage location if there were no other chests, NO_DISTANCE for dead
+     * cells from which it is impossible. */
+    int *goalDistances;
+    bool *isChest;
+    int *reachMarks;
+    int reachMark;
+    int *areaMarks;
+    int areaMark;
+    int *queue;
+    /* Packed keys of successors of a single state. */
+    unsigned char *successorKeys;
+};
+
+typedef struct Solver Solver;
+
+/* Number of states visited by a search and memory they took, records
+ * with their share of the index apart from the rest of the blocks. */
+struct SearchStats {
+    int numOfStates;
+    double bytesPerRecord;
+    size_t arenaOverhead;
+};
+
+typedef struct SearchStats SearchStats;
+
+/* Returns false if the level is too large to be searched. */
+bool initSolver(Solver *solver, Game *game);
+
+void disposeSolver(Solver *solver);
+
+void getGameSearchState(Solver *solver, Game *game, SearchState *state);
+
+bool isSolvedSearchState(Solver *solver, SearchState *state);
+
+/* Lower bound of number of pushes needed to solve given state, sum of goal
+ * distances of its chests, or NO_DISTANCE if some chest is on a dead cell
+ * and the state cannot be solved. */
+int getSearchStateHeuristic(Solver *solver, SearchState *state);
+
+/* Computes states reachable with a single push and, where it goes farther,
+ * with a macro push, pushes onto dead cells are skipped. Returns number
+ * of successors. */
+int expandPushes(Solver *solver, SearchState *state, SearchState successors[]);
+
+/* Computes states from which given state is reachable with a single push,
+ * that is states reachable with a single pull. Returns number of them. */
+int expandPulls(Solver *solver, SearchState *state, SearchState successors[]);
+
+/* Computes states with all chests on storage locations, one for each area
+ * player can be in. Returns number of them, zero if there are more storage
+ * locations than chests. States array must hold numOfCells states. */
+int getSolvedSearchStates(Solver *solver, SearchState states[]);
+
+/* Appends push commands leading from state to next state, which is its
+ * successor. Names of chests are tracked in chestAtCell. */
+void addStepCommands(Solver *solver, SearchState *state, SearchState *next,
+                     int chestAtCell[], CommandList *commands);
+
+/* Returns number of pushes of step from state to its successor next. */
+int getStepNumOfPushes(Solver *solver, SearchState *state, SearchState *next);
+
+/* Returns number of player moves, walking and pushing, of step from state to
+ * its successor next, made by player standing at given cell. Cell is updated
+ * to the one player stands at after the step. */
+int getStepNumOfMoves(Solver *solver, SearchState *state, SearchState *next,
+                      int *playerCell);
+
+/* Initializes chestAtCell with numbers of chests of the game. */
+void initChestAtCell(Solver *solver, Game *game, int chestAtCell[]);
+
+/* Finds solution by bidirectional breadth-first search: forward search
+ * pushes chests from the initial state and backward search pulls them from
+ * states with all chests on storage locations, until both meet. Forward
+ * steps are single pushes or macro pushes, backward steps are single pulls,
+ * so the solution is short but need not be the shortest in either metric.
+ * When backward search is not possible, forward search alone finds the
+ * solution with the least number of steps, each a single or a macro push.
+ * States are interned in compact state stores. Returns false if there
+ * is no solution or it was not found within maxNumOfStates states. Fills
+ * stats unless they are NULL. */
+bool solveGame(Game *game, CommandList *solution, int maxNumOfStates,
+               SearchStats *stats);
+
+static inline int getCellRow(Solver *solver, int cell) {
+    return cell / solver->analysis->numOfCols;
+}
+
+static inline int getCellCol(Solver *solver, int cell) {
+    return cell % solver->analysis->numOfCols;
+}
+
+static inline bool isFloorSearchCell(Solver *solver, int cell) {
+    return 0 <= cell && cell < solver->numOfCells
+           && (solver->analysis->cells[cell] & WALL_CELL) == 0;
+}
+
+static inline bool isGoalSearchCell(Solver *solver, int cell) {
+    return (solver->analysis->cells[cell] & GOAL_CELL) != 0;
+}
+
+static inline bool isDeadSearchCell(Solver *solver, int cell) {
+    return solver->goalDistances[cell] == NO_DISTANCE;
+}
+
+#endif // SOLVER_H
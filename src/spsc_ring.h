@@ -0,0 +1,142 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <pthread.h>
+
+#define CACHE_LINE_SIZE 64
+#define RING_SPIN_LIMIT 64
+
+/* Lock-free ring buffer of fixed-size elements for exactly one producer
+ * thread and one consumer thread. Capacity has to be a power of two.
+ * Head is written only by consumer and tail only by producer, each of them
+ * lives in its own cache line so that the threads do not share lines.
+ * Thread waiting for the other one spins for a while and then sleeps
+ * on the condition variable, the other thread wakes it only if it
+ * registered itself as a waiter, so that there are no system calls
+ * while both threads keep up. */
+struct SpscRing {
+    char *elements;
+    size_t elementSize;
+    size_t mask;
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t head;
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t tail;
+    _Alignas(CACHE_LINE_SIZE) atomic_int numOfWaiters;
+    pthread_mutex_t lock;
+    pthread_cond_t wakeUp;
+};
+
+typedef struct SpscRing SpscRing;
+
+static inline void initSpscRing(SpscRing *ring, size_t capacity, size_t elementSize) {
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+    ring->elements = malloc(capacity * elementSize);
+    assert(ring->elements != NULL);
+    ring->elementSize = elementSize;
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->numOfWaiters, 0);
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->wakeUp, NULL);
+}
+
+static inline bool tryPushToRing(SpscRing *ring, const void *element) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail - head > ring->mask) {
+        return false;
+    }
+    memcpy(ring->elements + (tail & ring->mask) * ring->elementSize,
+           element, ring->elementSize);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+static inline bool tryPopFromRing(SpscRing *ring, void *element) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    memcpy(element, ring->elements + (head & ring->mask) * ring->elementSize,
+           ring->elementSize);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+/* Wakes the other thread if it sleeps waiting for the ring. Fence orders
+ * the preceding update of head or tail before reading number of waiters,
+ * the same as in sleepOnRing, so that either the waiter sees the update
+ * or it is seen here. */
+static inline void notifyRingWaiter(SpscRing *ring) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ring->numOfWaiters, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_broadcast(&ring->wakeUp);
+        pthread_mutex_unlock(&ring->lock);
+    }
+}
+
+static inline bool isRingFull(SpscRing *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return tail - head > ring->mask;
+}
+
+static inline bool isRingEmpty(SpscRing *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return head == tail;
+}
+
+/* Sleeps while the ring is full, if producer waits, or empty otherwise. */
+static inline void sleepOnRing(SpscRing *ring, bool isProducer) {
+    pthread_mutex_lock(&ring->lock);
+    atomic_fetch_add_explicit(&ring->numOfWaiters, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (isProducer ? isRingFull(ring) : isRingEmpty(ring)) {
+        pthread_cond_wait(&ring->wakeUp, &ring->lock);
+    }
+    atomic_fetch_sub_explicit(&ring->numOfWaiters, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/* Waits until there is a free slot in the ring. */
+static inline void pushToRing(SpscRing *ring, const void *element) {
+    for (int i = 0; !tryPushToRing(ring, element); i++) {
+        if (i < RING_SPIN_LIMIT) {
+            sched_yield();
+        }
+        else {
+            sleepOnRing(ring, true);
+        }
+    }
+    notifyRingWaiter(ring);
+}
+
+/* Waits until there is an element in the ring. */
+static inline void popFromRing(SpscRing *ring, void *element) {
+    for (int i = 0; !tryPopFromRing(ring, element); i++) {
+        if (i < RING_SPIN_LIMIT) {
+            sched_yield();
+        }
+        else {
+            sleepOnRing(ring, false);
+        }
+    }
+    notifyRingWaiter(ring);
+}
+
+static inline void disposeSpscRing(SpscRing *ring) {
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->wakeUp);
+    free(ring->elements);
+}
+
+#endif // SPSC_RING_H
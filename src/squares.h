@@ -34,6 +34,16 @@ static inline bool isLegalSquare(char square) {
     return isBlankSquare(square) || isPlayerSquare(square);
 }
 
+/* Checks if square is a storage location, whatever stands on it. */
+static inline bool isFinalSquare(char square) {
+    return square == FINAL_BLANK_SQUARE || square == FINAL_PLAYER_SQUARE ||
+           isFinalChestSquare(square);
+}
+
+static inline bool isWallSquare(char square) {
+    return !isLegalSquare(square) && !isChestSquare(square);
+}
+
 static inline int getChestNum(char chestName) {
     if (isFinalChestSquare(chestName)) {
         return chestName - 'A';
@@ -0,0 +1,141 @@
+#include "state_store.h"
+
+#define STATE_STORE_BLOCK_SIZE (1 << 20)
+#define STATE_STORE_INITIAL_SLOTS 64
+#define PARENT_SIZE ((int) sizeof(int))
+
+void initStateStore(StateStore *store, StatePacker *packer, int numOfChests) {
+    store->packer = packer;
+    store->numOfChests = numOfChests;
+    store->keySize = packer->keySize;
+    store->recordSize = store->keySize + PARENT_SIZE;
+
+    /* Blocks hold a power of two records, so that a record is found
+     * with a shift and a mask. */
+    store->recordsPerBlockShift = 0;
+    while ((2 << store->recordsPerBlockShift) * store->recordSize <= STATE_STORE_BLOCK_SIZE) {
+        store->recordsPerBlockShift++;
+    }
+    store->numOfBlocks = 0;
+    store->blocksCapacity = INITIAL_CAPACITY;
+    store->blocks = malloc(store->blocksCapacity * sizeof(unsigned char *));
+    assert(store->blocks != NULL);
+    store->size = 0;
+
+    store->numOfSlots = STATE_STORE_INITIAL_SLOTS;
+    store->slots = calloc(store->numOfSlots, sizeof(uint32_t));
+    assert(store->slots != NULL);
+}
+
+uint64_t hashStateKey(StateStore *store, const unsigned char *key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < store->keySize; i++) {
+        hash = (hash ^ key[i]) * 1099511628211ULL;
+    }
+    return hash ^ (hash >> 29);
+}
+
+int findStateKey(StateStore *store, const unsigned char *key, uint64_t hash) {
+    int mask = store->numOfSlots - 1;
+    for (int slot = (int) (hash & mask); store->slots[slot] != 0; slot = (slot + 1) & mask) {
+        int index = (int) store->slots[slot] - 1;
+        if (memcmp(getStoredRecord(store, index), key, store->keySize) == 0) {
+            return index;
+        }
+    }
+    return NO_STORED_STATE;
+}
+
+static void insertToSlots(StateStore *store, int index, uint64_t hash) {
+    int mask = store->numOfSlots - 1;
+    int slot = (int) (hash & mask);
+    while (store->slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    store->slots[slot] = (uint32_t) index + 1;
+}
+
+static void growSlots(StateStore *store) {
+    free(store->slots);
+    store->numOfSlots *= 2;
+    store->slots = calloc(store->numOfSlots, sizeof(uint32_t));
+    assert(store->slots != NULL);
+    for (int i = 0; i < store->size; i++) {
+        insertToSlots(store, i, hashStateKey(store, getStoredRecord(store, i)));
+    }
+}
+
+static void addBlock(StateStore *store) {
+    if (store->numOfBlocks == store->blocksCapacity) {
+        store->blocksCapacity *= GROWTH_FACTOR;
+        store->blocks = realloc(store->blocks,
+                                store->blocksCapacity * sizeof(unsigned char *));
+        assert(store->blocks != NULL);
+    }
+    store->blocks[store->numOfBlocks] =
+            malloc((size_t) store->recordSize << store->recordsPerBlockShift);
+    assert(store->blocks[store->numOfBlocks] != NULL);
+    store->numOfBlocks++;
+}
+
+int addStateKey(StateStore *store, const unsigned char *key, uint64_t hash, int parent) {
+    /* Load factor is kept at most 3/4. */
+    if (4 * (store->size + 1) > 3 * store->numOfSlots) {
+        growSlots(store);
+    }
+    if (store->size == store->numOfBlocks << store->recordsPerBlockShift) {
+        addBlock(store);
+    }
+
+    int index = store->size;
+    unsigned char *record = getStoredRecord(store, index);
+    memcpy(record, key, store->keySize);
+    memcpy(record + store->keySize, &parent, PARENT_SIZE);
+    store->size++;
+    insertToSlots(store, index, hash);
+    return index;
+}
+
+int findStoredState(StateStore *store, SearchState *state) {
+    unsigned char key[MAX_PACKED_KEY_SIZE];
+    packStateKey(store, state, key);
+    return findStateKey(store, key, hashStateKey(store, key));
+}
+
+int addStoredState(StateStore *store, SearchState *state, int parent) {
+    unsigned char key[MAX_PACKED_KEY_SIZE];
+    packStateKey(store, state, key);
+    return addStateKey(store, key, hashStateKey(store, key), parent);
+}
+
+void getStoredState(StateStore *store, int index, SearchState *state) {
+    unpackSearchState(store->packer, getStoredRecord(store, index), state);
+}
+
+int getStoredParent(StateStore *store, int index) {
+    int parent;
+    memcpy(&parent, getStoredRecord(store, index) + store->keySize, PARENT_SIZE);
+    return parent;
+}
+
+double getStateStoreBytesPerRecord(StateStore *store) {
+    if (store->size == 0) {
+        return 0.0;
+    }
+    double bytes = (double) store->size * store->recordSize
+                   + (double) store->numOfSlots * sizeof(uint32_t);
+    return bytes / store->size;
+}
+
+size_t getStateStoreArenaOverhead(StateStore *store) {
+    size_t numOfRecords = (size_t) store->numOfBlocks << store->recordsPerBlockShift;
+    return (numOfRecords - store->size) * store->recordSize;
+}
+
+void disposeStateStore(StateStore *store) {
+    for (int i = 0; i < store->numOfBlocks; i++) {
+        free(store->blocks[i]);
+    }
+    free(store->blocks);
+    free(store->slots);
+}
@@ -0,0 +1,78 @@
+#ifndef STATE_STORE_H
+#define STATE_STORE_H
+
+#include "packed_state.h"
+
+#define NO_STORED_STATE (-1)
+
+/* Interned search states, each kept once as its packed key followed by
+ * index of the state it was reached from. Records are laid out one after
+ * another in blocks of an arena, which only grows by adding blocks, so
+ * they are never moved. Open addressing index holds numbers of records
+ * increased by one, zero marking empty slots. */
+struct StateStore {
+    StatePacker *packer;
+    int numOfChests;
+    int keySize;
+    int recordSize;
+    unsigned char **blocks;
+    int numOfBlocks;
+    int blocksCapacity;
+    int recordsPerBlockShift;
+    int size;
+    uint32_t *slots;
+    int numOfSlots;
+};
+
+typedef struct StateStore StateStore;
+
+/* Packer has to outlive the store. */
+void initStateStore(StateStore *store, StatePacker *packer, int numOfChests);
+
+/* FNV-1a over bytes of the key. */
+uint64_t hashStateKey(StateStore *store, const unsigned char *key);
+
+/* Returns index of state with given key and hash or NO_STORED_STATE
+ * if it is not in the store. */
+int findStateKey(StateStore *store, const unsigned char *key, uint64_t hash);
+
+/* Adds state with given key and hash, which is not in the store yet,
+ * and returns its index. */
+int addStateKey(StateStore *store, const unsigned char *key, uint64_t hash, int parent);
+
+int findStoredState(StateStore *store, SearchState *state);
+
+int addStoredState(StateStore *store, SearchState *state, int parent);
+
+void getStoredState(StateStore *store, int index, SearchState *state);
+
+int getStoredParent(StateStore *store, int index);
+
+/* Memory taken by records and slots of the index, divided by number
+ * of states. */
+double getStateStoreBytesPerRecord(StateStore *store);
+
+/* Memory of allocated blocks not taken by records yet. */
+size_t getStateStoreArenaOverhead(StateStore *store);
+
+void disposeStateStore(StateStore *store);
+
+static inline unsigned char *getStoredRecord(StateStore *store, int index) {
+    int block = index >> store->recordsPerBlockShift;
+    int offset = index & ((1 << store->recordsPerBlockShift) - 1);
+    return store->blocks[block] + (size_t) offset * store->recordSize;
+}
+
+static inline void packStateKey(StateStore *store, SearchState *state,
+                                unsigned char *key) {
+    packSearchState(store->packer, state, store->numOfChests, key);
+}
+
+/* Starts loading slot a key with given hash is looked up from, so that
+ * keys of many successors can be hashed first and looked up when their
+ * slots are already in cache. */
+static inline void prefetchStateKey(StateStore *store, uint64_t hash) {
+    __builtin_prefetch(&store->slots[hash & (store->numOfSlots - 1)]);
+}
+
+#endif // STATE_STORE_H
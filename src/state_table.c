@@ -0,0 +1,69 @@
+#include "state_table.h"
+
+#define STATE_TABLE_INITIAL_CAPACITY 1024
+#define STATE_TABLE_GROWTH_FACTOR 2
+#define EMPTY_SLOT (-1)
+
+static void clearSlots(StateTable *table) {
+    for (int i = 0; i < table->numOfSlots; i++) {
+        table->slots[i] = EMPTY_SLOT;
+    }
+}
+
+void initStateTable(StateTable *table, int numOfChests) {
+    table->numOfChests = numOfChests;
+    table->size = 0;
+    table->capacity = STATE_TABLE_INITIAL_CAPACITY;
+    table->entries = malloc(table->capacity * sizeof(StateEntry));
+    assert(table->entries != NULL);
+    table->numOfSlots = 2 * STATE_TABLE_INITIAL_CAPACITY;
+    table->slots = malloc(table->numOfSlots * sizeof(int));
+    assert(table->slots != NULL);
+    clearSlots(table);
+}
+
+static int findSlot(StateTable *table, SearchState *state) {
+    int mask = table->numOfSlots - 1;
+    int slot = (int) (hashSearchState(state, table->numOfChests) & mask);
+    while (table->slots[slot] != EMPTY_SLOT &&
+           !areSearchStatesEqual(&table->entries[table->slots[slot]].state, state)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/* Keeps load factor of slots below one half. */
+static void reallocStateTable(StateTable *table) {
+    table->capacity *= STATE_TABLE_GROWTH_FACTOR;
+    table->entries = realloc(table->entries, table->capacity * sizeof(StateEntry));
+    assert(table->entries != NULL);
+
+    table->numOfSlots = 2 * table->capacity;
+    table->slots = realloc(table->slots, table->numOfSlots * sizeof(int));
+    assert(table->slots != NULL);
+    clearSlots(table);
+    for (int i = 0; i < table->size; i++) {
+        table->slots[findSlot(table, &table->entries[i].state)] = i;
+    }
+}
+
+int findState(StateTable *table, SearchState *state) {
+    return table->slots[findSlot(table, state)];
+}
+
+int addState(StateTable *table, SearchState *state, int parent) {
+    if (table->size == table->capacity) {
+        reallocStateTable(table);
+    }
+    int index = table->size;
+    table->entries[index].state = *state;
+    table->entries[index].parent = parent;
+    table->slots[findSlot(table, state)] = index;
+    table->size++;
+    return index;
+}
+
+void disposeStateTable(StateTable *table) {
+    free(table->entries);
+    free(table->slots);
+}
@@ -0,0 +1,47 @@
+#ifndef STATE_TABLE_H
+#define STATE_TABLE_H
+
+#include "search_state.h"
+
+#define NO_PARENT (-1)
+
+struct StateEntry {
+    SearchState state;
+    int parent;
+};
+
+typedef struct StateEntry StateEntry;
+
+/* States in order of insertion, each with index of the state it was reached
+ * from, together with open addressing index for finding them. States of
+ * breadth-first search layer form a contiguous range of entries. */
+struct StateTable {
+    StateEntry *entries;
+    int size;
+    int capacity;
+    int *slots;
+    int numOfSlots;
+    int numOfChests;
+};
+
+typedef struct StateTable StateTable;
+
+void initStateTable(StateTable *table, int numOfChests);
+
+/* Returns index of given state or -1 if it is not in the table. */
+int findState(StateTable *table, SearchState *state);
+
+/* Adds state which is not in the table yet and returns its index. */
+int addState(StateTable *table, SearchState *state, int parent);
+
+void disposeStateTable(StateTable *table);
+
+static inline SearchState *getTableState(StateTable *table, int index) {
+    return &table->entries[index].state;
+}
+
+static inline int getTableParent(StateTable *table, int index) {
+    return table->entries[index].parent;
+}
+
+#endif // STATE_TABLE_H
@@ -0,0 +1,54 @@
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEXT_BUFFER_GROWTH_FACTOR 2
+#define TEXT_BUFFER_INITIAL_CAPACITY 256
+
+struct TextBuffer {
+    char *text;
+    int size;
+    int capacity;
+};
+
+typedef struct TextBuffer TextBuffer;
+
+static inline void initTextBuffer(TextBuffer *buffer) {
+    buffer->size = 0;
+    buffer->capacity = TEXT_BUFFER_INITIAL_CAPACITY;
+    buffer->text = malloc(buffer->capacity * sizeof(char));
+    assert(buffer->text != NULL);
+}
+
+static inline void reserveTextBuffer(TextBuffer *buffer, int size) {
+    while (buffer->capacity < size) {
+        buffer->capacity *= TEXT_BUFFER_GROWTH_FACTOR;
+        buffer->text = realloc(buffer->text, buffer->capacity * sizeof(char));
+        assert(buffer->text != NULL);
+    }
+}
+
+static inline void appendToTextBuffer(TextBuffer *buffer, const char *text, int size) {
+    reserveTextBuffer(buffer, buffer->size + size);
+    memcpy(buffer->text + buffer->size, text, size);
+    buffer->size += size;
+}
+
+static inline void addToTextBuffer(TextBuffer *buffer, char c) {
+    appendToTextBuffer(buffer, &c, 1);
+}
+
+/* Removes first size characters from the buffer. */
+static inline void consumeTextBuffer(TextBuffer *buffer, int size) {
+    memmove(buffer->text, buffer->text + size, buffer->size - size);
+    buffer->size -= size;
+}
+
+static inline void disposeTextBuffer(TextBuffer *buffer) {
+    free(buffer->text);
+}
+
+#endif // TEXT_BUFFER_H
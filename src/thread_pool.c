@@ -0,0 +1,59 @@
+#include <unistd.h>
+
+#include "thread_pool.h"
+
+struct PoolWorker {
+    ThreadPool *pool;
+    int worker;
+};
+
+typedef struct PoolWorker PoolWorker;
+
+static void *runPoolWorker(void *arg) {
+    PoolWorker *poolWorker = arg;
+    ThreadPool *pool = poolWorker->pool;
+
+    int task = atomic_fetch_add(&pool->nextTask, 1);
+    while (task < pool->numOfTasks) {
+        pool->function(pool->context, poolWorker->worker, task);
+        task = atomic_fetch_add(&pool->nextTask, 1);
+    }
+    return NULL;
+}
+
+int getDefaultNumOfPoolThreads() {
+    int numOfThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (numOfThreads < 1) {
+        return 1;
+    }
+    return numOfThreads < MAX_NUM_OF_POOL_THREADS ? numOfThreads : MAX_NUM_OF_POOL_THREADS;
+}
+
+void runTasksInPool(int numOfThreads, int numOfTasks, PoolTaskFunction function,
+                    void *context) {
+    ThreadPool pool;
+    pool.numOfThreads = numOfThreads < MAX_NUM_OF_POOL_THREADS ? numOfThreads
+                                                               : MAX_NUM_OF_POOL_THREADS;
+    pool.numOfTasks = numOfTasks;
+    atomic_init(&pool.nextTask, 0);
+    pool.function = function;
+    pool.context = context;
+
+    /* If a thread cannot be created, the calling thread takes its place
+     * and shares the tasks with threads already running. */
+    PoolWorker workers[MAX_NUM_OF_POOL_THREADS];
+    int numOfStarted = 0;
+    while (numOfStarted < pool.numOfThreads) {
+        workers[numOfStarted].pool = &pool;
+        workers[numOfStarted].worker = numOfStarted;
+        if (pthread_create(&pool.threads[numOfStarted], NULL, runPoolWorker,
+                           &workers[numOfStarted]) != 0) {
+            runPoolWorker(&workers[numOfStarted]);
+            break;
+        }
+        numOfStarted++;
+    }
+    for (int i = 0; i < numOfStarted; i++) {
+        pthread_join(pool.threads[i], NULL);
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define MAX_NUM_OF_POOL_THREADS 64
+
+/* Runs a single task, worker is the number of thread running it. */
+typedef void (*PoolTaskFunction)(void *context, int worker, int task);
+
+/* Fixed group of threads taking tasks numbered from zero in order,
+ * each thread takes the next task as soon as it finishes the previous one. */
+struct ThreadPool {
+    pthread_t threads[MAX_NUM_OF_POOL_THREADS];
+    int numOfThreads;
+    int numOfTasks;
+    atomic_int nextTask;
+    PoolTaskFunction function;
+    void *context;
+};
+
+typedef struct ThreadPool ThreadPool;
+
+/* Returns number of threads worth running, one per processor. */
+int getDefaultNumOfPoolThreads();
+
+/* Runs given number of tasks on numOfThreads threads and waits
+ * until all of them are done. */
+void runTasksInPool(int numOfThreads, int numOfTasks, PoolTaskFunction function,
+                    void *context);
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,235 @@
+#include "warehouse.h"
+
+/* Takes workers off the board, squares under them become empty squares.
+ * Player stands for the first worker, also on a storage location. */
+static void findWorkersPositions(Warehouse *warehouse, Board *board) {
+    for (int i = 0; i < MAX_NUM_OF_WORKERS; i++) {
+        warehouse->workersPos[i] = NULL;
+    }
+
+    for (int i = 0; i < board->size; i++) {
+        for (int j = 0; j < board->rows[i]->size; j++) {
+            char square = board->rows[i]->squares[j];
+            if (isWorkerSquare(square) || isPlayerSquare(square)) {
+                int workerNum = isWorkerSquare(square) ? getWorkerNum(square) : 0;
+                free(warehouse->workersPos[workerNum]);
+                warehouse->workersPos[workerNum] = getNewPosition(i, j);
+                board->rows[i]->squares[j] = square == FINAL_PLAYER_SQUARE
+                                             ? FINAL_BLANK_SQUARE : BLANK_SQUARE;
+            }
+        }
+    }
+}
+
+void initWarehouse(Warehouse *warehouse, Board *board) {
+    findWorkersPositions(warehouse, board);
+    warehouse->playerPos.row = -1;
+    warehouse->playerPos.col = -1;
+    initGame(&warehouse->game, board, &warehouse->playerPos);
+    warehouse->analysis = getLevelAnalysis(&warehouse->game);
+
+    int numOfCells = warehouse->analysis->numOfRows * warehouse->analysis->numOfCols;
+    warehouse->areas = malloc(numOfCells * sizeof(int));
+    assert(warehouse->areas != NULL);
+    warehouse->areaMarks = calloc(numOfCells, sizeof(int));
+    assert(warehouse->areaMarks != NULL);
+    warehouse->areaMark = 0;
+    warehouse->areaWorkers = malloc(numOfCells * sizeof(int));
+    assert(warehouse->areaWorkers != NULL);
+    warehouse->queue = malloc(numOfCells * sizeof(int));
+    assert(warehouse->queue != NULL);
+}
+
+static bool isFreeWarehouseCell(Warehouse *warehouse, int row, int col) {
+    return !hasCellFlag(warehouse->analysis, row, col, WALL_CELL)
+           && !isChestSquare(warehouse->game.board->rows[row]->squares[col]);
+}
+
+/* Flood fills area of given start cell with given area number. */
+static void fillWorkerArea(Warehouse *warehouse, int start, int area) {
+    LevelAnalysis *analysis = warehouse->analysis;
+    const int rowDeltas[] = {-1, 0, 1, 0};
+    const int colDeltas[] = {0, 1, 0, -1};
+
+    warehouse->areas[start] = area;
+    warehouse->areaMarks[start] = warehouse->areaMark;
+    warehouse->queue[0] = start;
+    int size = 1;
+    for (int i = 0; i < size; i++) {
+        int cell = warehouse->queue[i];
+        int row = cell / analysis->numOfCols;
+        int col = cell % analysis->numOfCols;
+        for (int d = 0; d < 4; d++) {
+            int neighborRow = row + rowDeltas[d];
+            int neighborCol = col + colDeltas[d];
+            if (!isFreeWarehouseCell(warehouse, neighborRow, neighborCol)) {
+                continue;
+            }
+            int neighbor = getCellIndex(analysis, neighborRow, neighborCol);
+            if (warehouse->areaMarks[neighbor] != warehouse->areaMark) {
+                warehouse->areas[neighbor] = area;
+                warehouse->areaMarks[neighbor] = warehouse->areaMark;
+                warehouse->queue[size] = neighbor;
+                size++;
+            }
+        }
+    }
+}
+
+void labelWorkerAreas(Warehouse *warehouse) {
+    warehouse->areaMark++;
+    int numOfAreas = 0;
+    for (int i = 0; i < MAX_NUM_OF_WORKERS; i++) {
+        Position *workerPos = warehouse->workersPos[i];
+        if (workerPos == NULL) {
+            continue;
+        }
+
+        /* Worker standing in an area labeled from a worker with lower number
+         * shares it, otherwise it starts a new one. */
+        int cell = getCellIndex(warehouse->analysis, workerPos->row, workerPos->col);
+        if (warehouse->areaMarks[cell] != warehouse->areaMark) {
+            warehouse->areaWorkers[numOfAreas] = 0;
+            fillWorkerArea(warehouse, cell, numOfAreas);
+            numOfAreas++;
+        }
+        warehouse->areaWorkers[warehouse->areas[cell]] |= 1 << i;
+    }
+}
+
+bool canWorkerApproach(Warehouse *warehouse, int workerNum, Position *pos) {
+    if (!isCellInRange(warehouse->analysis, pos->row, pos->col)) {
+        return false;
+    }
+    int cell = getCellIndex(warehouse->analysis, pos->row, pos->col);
+    return warehouse->areaMarks[cell] == warehouse->areaMark
+           && (warehouse->areaWorkers[warehouse->areas[cell]] & (1 << workerNum)) != 0;
+}
+
+static bool isWorkerAt(Warehouse *warehouse, Position *pos) {
+    for (int i = 0; i < MAX_NUM_OF_WORKERS; i++) {
+        if (arePositionsEqual(warehouse->workersPos[i], pos)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool isWorkerCommandPossible(Warehouse *warehouse, WorkerCommand *command) {
+    Game *game = &warehouse->game;
+    PushCommand *pushComm = &command->pushComm;
+    if (getChestPosition(game, pushComm->chestNum) == NULL
+        || !isChestPushPossible(game, pushComm)) {
+        return false;
+    }
+
+    Position targetChestPos;
+    initTargetChestPosition(game, pushComm, &targetChestPos);
+    Position targetPlayerPos;
+    initTargetPlayerPosition(game, pushComm, &targetPlayerPos);
+    return !isWorkerAt(warehouse, &targetChestPos)
+           && canWorkerApproach(warehouse, command->workerNum, &targetPlayerPos);
+}
+
+static void executeWorkerCommand(Warehouse *warehouse, WorkerCommand *command) {
+    Game *game = &warehouse->game;
+    Position *chestPos = getChestPosition(game, command->pushComm.chestNum);
+    Position *workerPos = warehouse->workersPos[command->workerNum];
+
+    Position targetChestPos;
+    initTargetChestPosition(game, &command->pushComm, &targetChestPos);
+    setCurrentChestSquareToBlankSquare(game, chestPos);
+    workerPos->row = chestPos->row;
+    workerPos->col = chestPos->col;
+    chestPos->row = targetChestPos.row;
+    chestPos->col = targetChestPos.col;
+    setCurrentBlankSquareToChestSquare(game, chestPos, command->pushComm.chestNum);
+    moveChestInEngine(&game->engine, workerPos, chestPos);
+}
+
+int executeWorkerCommands(Warehouse *warehouse, WorkerCommand commands[],
+                          int numOfCommands) {
+    WorkerCommand *workerCommands[MAX_NUM_OF_WORKERS];
+    for (int i = 0; i < MAX_NUM_OF_WORKERS; i++) {
+        workerCommands[i] = NULL;
+    }
+    for (int i = 0; i < numOfCommands; i++) {
+        int workerNum = commands[i].workerNum;
+        int chestNum = commands[i].pushComm.chestNum;
+        if (0 <= workerNum && workerNum < MAX_NUM_OF_WORKERS
+            && warehouse->workersPos[workerNum] != NULL
+            && workerCommands[workerNum] == NULL
+            && 0 <= chestNum && chestNum < NUM_OF_CHESTS) {
+            workerCommands[workerNum] = &commands[i];
+        }
+    }
+
+    labelWorkerAreas(warehouse);
+
+    /* All commands are checked before any of them is executed. */
+    bool isChestClaimed[NUM_OF_CHESTS] = {false};
+    Position claimedSquares[MAX_NUM_OF_WORKERS];
+    WorkerCommand *executed[MAX_NUM_OF_WORKERS];
+    int numOfExecuted = 0;
+    for (int i = 0; i < MAX_NUM_OF_WORKERS; i++) {
+        WorkerCommand *command = workerCommands[i];
+        if (command == NULL || isChestClaimed[command->pushComm.chestNum]
+            || !isWorkerCommandPossible(warehouse, command)) {
+            continue;
+        }
+
+        Position targetChestPos;
+        initTargetChestPosition(&warehouse->game, &command->pushComm, &targetChestPos);
+        bool isSquareClaimed = false;
+        for (int j = 0; j < numOfExecuted; j++) {
+            if (arePositionsEqual(&claimedSquares[j], &targetChestPos)) {
+                isSquareClaimed = true;
+            }
+        }
+        if (isSquareClaimed) {
+            continue;
+        }
+
+        isChestClaimed[command->pushComm.chestNum] = true;
+        claimedSquares[numOfExecuted] = targetChestPos;
+        executed[numOfExecuted] = command;
+        numOfExecuted++;
+    }
+
+    for (int i = 0; i < numOfExecuted; i++) {
+        executeWorkerCommand(warehouse, executed[i]);
+    }
+    return numOfExecuted;
+}
+
+void printWarehouse(Warehouse *warehouse) {
+    Board *board = warehouse->game.board;
+    char squares[MAX_NUM_OF_WORKERS];
+    for (int i = 0; i < MAX_NUM_OF_WORKERS; i++) {
+        Position *workerPos = warehouse->workersPos[i];
+        if (workerPos != NULL) {
+            squares[i] = board->rows[workerPos->row]->squares[workerPos->col];
+            board->rows[workerPos->row]->squares[workerPos->col] = getWorkerName(i);
+        }
+    }
+
+    printBoard(board);
+
+    for (int i = 0; i < MAX_NUM_OF_WORKERS; i++) {
+        Position *workerPos = warehouse->workersPos[i];
+        if (workerPos != NULL) {
+            board->rows[workerPos->row]->squares[workerPos->col] = squares[i];
+        }
+    }
+}
+
+void disposeWarehouse(Warehouse *warehouse) {
+    for (int i = 0; i < MAX_NUM_OF_WORKERS; i++) {
+        free(warehouse->workersPos[i]);
+    }
+    free(warehouse->areas);
+    free(warehouse->areaMarks);
+    free(warehouse->areaWorkers);
+    free(warehouse->queue);
+    disposeGame(&warehouse->game);
+}
@@ -0,0 +1,73 @@
+#ifndef WAREHOUSE_H
+#define WAREHOUSE_H
+
+#include "game.h"
+
+#define MAX_NUM_OF_WORKERS 9
+#define NO_AREA (-1)
+
+static inline bool isWorkerSquare(char square) {
+    return '1' <= square && square <= '9';
+}
+
+static inline int getWorkerNum(char workerName) {
+    return workerName - '1';
+}
+
+static inline char getWorkerName(int workerNum) {
+    return (char) ('1' + workerNum);
+}
+
+struct WorkerCommand {
+    int workerNum;
+    PushCommand pushComm;
+};
+
+typedef struct WorkerCommand WorkerCommand;
+
+/* Board with many numbered workers, each of them pushing chests like
+ * the player of a game. Workers are kept apart from the board, which only
+ * holds chests, so they do not block each other, only chests and walls
+ * stop them. Areas workers can walk to are labeled once per tick by a single
+ * flood fill started from all of them, each area with a mask of workers
+ * standing in it. */
+struct Warehouse {
+    Game game;
+    Position playerPos;
+    Position *workersPos[MAX_NUM_OF_WORKERS];
+    LevelAnalysis *analysis;
+    /* Area of each cell, valid only if its mark is equal to current mark. */
+    int *areas;
+    int *areaMarks;
+    int areaMark;
+    int *areaWorkers;
+    int *queue;
+};
+
+typedef struct Warehouse Warehouse;
+
+/* Binds warehouse to already loaded board, takes workers off it. */
+void initWarehouse(Warehouse *warehouse, Board *board);
+
+/* Labels areas workers can walk to in the current state of the board. */
+void labelWorkerAreas(Warehouse *warehouse);
+
+/* Tells if worker can walk to given position, according to the last labeling. */
+bool canWorkerApproach(Warehouse *warehouse, int workerNum, Position *pos);
+
+/* Executes commands of a single tick. All of them are checked against the
+ * state from before the tick, in order of workers, so that the result does
+ * not depend on order of commands: worker executes at most one command,
+ * chest is pushed by at most one worker and square is entered by at most
+ * one chest. Commands which are not possible or conflict with commands
+ * of workers with lower numbers are skipped. Returns number of executed
+ * commands. */
+int executeWorkerCommands(Warehouse *warehouse, WorkerCommand commands[],
+                          int numOfCommands);
+
+/* Prints board with workers on it. */
+void printWarehouse(Warehouse *warehouse);
+
+void disposeWarehouse(Warehouse *warehouse);
+
+#endif // WAREHOUSE_H